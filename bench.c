@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <string.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_timer.h>
+#include "life.h"
+
+// benchmark: every engine over a matrix of grid sizes, soup densities and
+// patterns, as JSON on stdout. step latencies are timed one step() at a time.
+//
+//     bench [-n generations] [-t threads] [-e engine] [-s scalar|sse2|avx2] [-l rule]
+//           [-f generations]
+//
+// -n is the generation count on the smallest grid. bigger grids run fewer
+// generations so every size costs about the same number of cell updates,
+// but every case times at least MIN_SAMPLES steps for its percentiles
+// unless that takes longer than CASE_SECONDS.
+// -f has the bits engine step that many generations per pass over the grid.
+
+#define WARMUP_STEPS 16
+#define MIN_SAMPLES 100
+#define CASE_SECONDS 10
+
+// hashlife memoizes nothing on a soup and spends minutes a generation on
+// the bigger ones, so it only steps soups up to this many cells
+#define HASHLIFE_MAX_SOUP (4096 * 4096)
+
+struct bench_pattern {
+    const char *name;
+    double density; // soup only
+};
+
+static const struct bench_pattern bench_patterns[] = {
+    {"soup", 0.05},
+    {"soup", 0.25},
+    {"soup", 0.5},
+    {"rpent", 0},
+    {"gosper", 0},
+    {"acorn", 0},
+};
+
+// grid sizes as rows x cols, from well inside L1 to far past the last level
+// cache
+static const int bench_sizes[][2] = {
+    {64, 64},
+    {256, 256},
+    {1024, 1024},
+    {4096, 4096},
+    {16384, 16384},
+};
+
+static struct grid points;
+
+// generations on a grid, scaled down from the smallest one
+static uint64_t bench_generations(uint64_t generations, int rows, int cols) {
+
+    double scale = (double)bench_sizes[0][0] * bench_sizes[0][1] / ((double)rows * cols);
+
+    return SDL_max((uint64_t)(generations * scale), 1);
+}
+
+static int compare_nanos(const void *a, const void *b) {
+
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+// nearest rank percentile of sorted samples
+static uint64_t percentile(const uint64_t *sorted, int count, int p) {
+
+    int rank = (int)(((int64_t)count * p + 99) / 100);
+
+    return sorted[SDL_clamp(rank, 1, count) - 1];
+}
+
+static void bench_error(const struct engine *engine, const struct bench_pattern *pattern, int rows, int cols, int first) {
+    printf("%s\n    {\"engine\": \"%s\", \"pattern\": \"%s\", \"rows\": %d, \"cols\": %d, \"error\": \"out of memory\"}",
+           first ? "" : ",", engine->name, pattern->name, rows, cols);
+}
+
+static void bench_run(const struct engine *engine, const struct bench_pattern *pattern, int rows, int cols, uint64_t generations, uint64_t *nanos, int first) {
+
+    if (!load_pattern(&points, pattern->name, pattern->density, 1) || !engine->load(&points)) {
+        bench_error(engine, pattern, rows, cols, first);
+        return;
+    }
+
+    for (uint64_t i = 0; i < SDL_min(generations, WARMUP_STEPS); i++) {
+        if (!engine->step()) {
+            bench_error(engine, pattern, rows, cols, first);
+            return;
+        }
+    }
+
+    double freq = (double)SDL_GetPerformanceFrequency();
+    uint64_t generation = 0;
+    int steps = 0;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // past the generations, more samples until there are enough or the
+    // case ran out of time
+    while (generation < generations ||
+           (steps < MIN_SAMPLES && (SDL_GetPerformanceCounter() - start) < freq * CASE_SECONDS)) {
+        Uint64 before = SDL_GetPerformanceCounter();
+        uint64_t step = engine->step();
+        nanos[steps++] = (uint64_t)((SDL_GetPerformanceCounter() - before) * 1e9 / freq);
+
+        if (!step) {
+            bench_error(engine, pattern, rows, cols, first);
+            return;
+        }
+
+        generation += step;
+    }
+
+    double seconds = (SDL_GetPerformanceCounter() - start) / freq;
+
+    engine->store(&points);
+
+    SDL_qsort(nanos, steps, sizeof(*nanos), compare_nanos);
+
+    printf("%s\n    {\"engine\": \"%s\", \"pattern\": \"%s\", \"density\": %g, \"rows\": %d, \"cols\": %d, "
+           "\"generations\": %" SDL_PRIu64 ", \"steps\": %d, \"seconds\": %.6f, \"ns_per_gen\": %.1f, "
+           "\"cells_per_sec\": %.0f, \"p50_ns\": %" SDL_PRIu64 ", \"p99_ns\": %" SDL_PRIu64 ", \"samples\": %d, "
+           "\"population\": %" SDL_PRIu64 "}",
+           first ? "" : ",", engine->name, pattern->name, pattern->density, rows, cols,
+           generation, steps, seconds, seconds * 1e9 / generation,
+           (double)rows * cols * generation / seconds, percentile(nanos, steps, 50), percentile(nanos, steps, 99), steps,
+           count_population(&points));
+}
+
+int main(int argc, char *argv[]) {
+
+    uint64_t generations = 1 << 16;
+    int threads = 1;
+    const struct engine *only = NULL;
+
+    simd_level = detect_simd();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            generations = SDL_strtoull(argv[++i], NULL, 10);
+            generations = SDL_max(generations, 1);
+        }
+
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = SDL_atoi(argv[++i]);
+        }
+
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            only = find_engine(argv[++i]);
+
+            if (!only) {
+                printf("Unknown engine '%s'\n", argv[i]);
+                return 1;
+            }
+        }
+
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            if (!parse_rule(argv[++i], &rule)) {
+                printf("Unknown rule '%s', use B.../S... like B36/S23\n", argv[i]);
+                return 1;
+            }
+        }
+
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            int block = SDL_atoi(argv[++i]);
+            bits_block_generations = SDL_clamp(block, 1, MAX_BLOCK_GENERATIONS);
+        }
+
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            i++;
+
+            int level = SIMD_SCALAR;
+            while (level <= SIMD_AVX2 && strcmp(simd_names[level], argv[i]) != 0) {
+                level++;
+            }
+
+            if (level > SIMD_AVX2) {
+                printf("Unknown kernel level '%s', use scalar, sse2 or avx2\n", argv[i]);
+                return 1;
+            }
+
+            if (level < (int)simd_level) {
+                simd_level = level;
+            }
+        }
+    }
+
+    // one latency sample per step, and no engine steps less than a generation
+    uint64_t *nanos = SDL_malloc(SDL_max(generations, MIN_SAMPLES) * sizeof(*nanos));
+
+    if (!nanos || !workers_start(threads)) {
+        printf("Couldn't set up the benchmark!\n");
+        return 1;
+    }
+
+    char rule_text[32];
+    format_rule(&rule, rule_text, sizeof(rule_text));
+
+    printf("{\n  \"kernels\": \"%s\",\n  \"threads\": %d,\n  \"rule\": \"%s\",\n  \"block_generations\": %d,\n  \"results\": [",
+           simd_names[simd_level], worker_count(), rule_text, bits_block_generations);
+
+    int first = 1;
+
+    for (int s = 0; s < (int)SDL_arraysize(bench_sizes); s++) {
+        int rows = bench_sizes[s][0], cols = bench_sizes[s][1];
+
+        if (!init_points(&points, rows, cols)) {
+            printf("Couldn't allocate a %dx%d grid!\n", cols, rows);
+            return 1;
+        }
+
+        for (int e = 0; engines[e]; e++) {
+            if (only && engines[e] != only) {
+                continue;
+            }
+
+            // B0 fills empty space, which the unbounded engines have no end of
+            if ((rule.birth & 1) && !engine_bounded(engines[e])) {
+                continue;
+            }
+
+            for (int p = 0; p < (int)SDL_arraysize(bench_patterns); p++) {
+                if (engines[e] == &hashlife_engine && bench_patterns[p].density > 0 && (double)rows * cols > HASHLIFE_MAX_SOUP) {
+                    continue;
+                }
+
+                bench_run(engines[e], &bench_patterns[p], rows, cols, bench_generations(generations, rows, cols), nanos, first);
+                first = 0;
+                fflush(stdout);
+            }
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    free_points(&points);
+    workers_stop();
+    SDL_free(nanos);
+
+    return 0;
+}
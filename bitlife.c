@@ -0,0 +1,655 @@
+#include <stdint.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_intrin.h>
+#include "life.h"
+
+// bit-packed engine: 64 cells per word, bit i of word w is column w * 64 + i.
+// every row has a pad word on each side and there is a pad row above and
+// below the grid, so the kernel never has to bounds check a neighbor. the
+// pads are dead, or on a torus hold the opposite edge.
+
+static int bits_rows, bits_cols;
+static int bits_words;  // per row
+static int bits_stride; // bits_words and the two pad words
+
+static uint64_t *bits_cur;
+static uint64_t *bits_next;
+
+// first real word of a row
+static uint64_t *bits_row(uint64_t *grid, int row) {
+    return grid + (size_t)(row + 1) * bits_stride + 1;
+}
+
+// mask of the columns that exist in the last word of a row
+static uint64_t bits_last_mask(void) {
+    int used = bits_cols - (bits_words - 1) * 64;
+    return used == 64 ? ~0ULL : (1ULL << used) - 1;
+}
+
+// both buffers for a grid of rows x cols, pads and all zero
+static int bits_resize(int rows, int cols) {
+
+    size_t size = (size_t)(rows + 2) * ((cols + 63) / 64 + 2) * sizeof(uint64_t);
+
+    if (rows != bits_rows || cols != bits_cols) {
+        SDL_aligned_free(bits_cur);
+        SDL_aligned_free(bits_next);
+        bits_cur = SDL_aligned_alloc(CACHE_LINE, size);
+        bits_next = SDL_aligned_alloc(CACHE_LINE, size);
+
+        if (!bits_cur || !bits_next) {
+            bits_rows = bits_cols = 0;
+            return 0;
+        }
+
+        bits_rows = rows;
+        bits_cols = cols;
+        bits_words = (cols + 63) / 64;
+        bits_stride = bits_words + 2;
+    }
+
+    SDL_memset(bits_cur, 0, size);
+    SDL_memset(bits_next, 0, size);
+
+    return 1;
+}
+
+// copy the opposite edges of a row into its pads: column -1 is bit 63 of the
+// left pad word, column bits_cols the bit after the last column
+static void bits_wrap_row(uint64_t *words) {
+
+    int last = bits_cols - 1;
+    uint64_t *after = &words[bits_cols / 64];
+
+    words[-1] = (words[last / 64] >> (last % 64) & 1) << 63;
+    *after = (*after & ~(1ULL << (bits_cols % 64))) | (words[0] & 1) << (bits_cols % 64);
+}
+
+// the same for every row, and the pad rows
+static void bits_wrap(uint64_t *grid) {
+
+    for (int row = 0; row < bits_rows; row++) {
+        bits_wrap_row(bits_row(grid, row));
+    }
+
+    SDL_memcpy(bits_row(grid, -1) - 1, bits_row(grid, bits_rows - 1) - 1, bits_stride * sizeof(uint64_t));
+    SDL_memcpy(bits_row(grid, bits_rows) - 1, bits_row(grid, 0) - 1, bits_stride * sizeof(uint64_t));
+}
+
+
+// one row of output words from the three rows around it. the counting
+// kernels also add the cells born and died to lanes, the others leave it be
+typedef void (*bits_kernel)(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words,
+                            struct life_lanes *lanes);
+
+// births and deaths of a word. none of the levels skip unchanged words,
+// the branch cost more than the counting it saved even on settled soups
+SDL_FORCE_INLINE void bits_count_word(uint64_t was, uint64_t now, struct life_lanes *lanes) {
+
+    lanes->births[0] += life_popcount(now & ~was);
+    lanes->deaths[0] += life_popcount(was & ~now);
+}
+
+// the kernels are written once for any rule and compiled again for each of
+// SPECIALIZED_RULES with its masks as constants, see BITS_KERNELS below.
+// lanes is NULL for the ones that don't count
+SDL_FORCE_INLINE void bits_rule_scalar(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words,
+                                       unsigned birth, unsigned survive, struct life_lanes *lanes) {
+
+    for (int w = 0; w < words; w++) {
+        out[w] = rule_word(up, mid, down, w, birth, survive);
+
+        if (lanes) {
+            bits_count_word(mid[w], out[w], lanes);
+        }
+    }
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+// bits set in every byte, from the same adder tree as life_popcount()
+SDL_FORCE_INLINE SDL_TARGETING("sse2") __m128i bits_bytes_sse2(__m128i x) {
+
+    x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi64(x, 1), _mm_set1_epi8(0x55)));
+    x = _mm_add_epi8(_mm_and_si128(x, _mm_set1_epi8(0x33)), _mm_and_si128(_mm_srli_epi64(x, 2), _mm_set1_epi8(0x33)));
+
+    return _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi64(x, 4)), _mm_set1_epi8(0x0F));
+}
+
+// rule_apply() two words at a time, RULE_TERM() with and, or and xor only
+// so constant masks fold away
+#define BITS_TERM_SSE2(n, high, low) \
+    _mm_and_si128(_mm_and_si128(high, low), _mm_or_si128(_mm_and_si128(alive, _mm_set1_epi32(-(int)(survive >> (n) & 1))), \
+                                                     _mm_and_si128(dead, _mm_set1_epi32(-(int)(birth >> (n) & 1)))))
+
+SDL_FORCE_INLINE SDL_TARGETING("sse2") __m128i bits_apply_sse2(__m128i c0, __m128i c1, __m128i c2, __m128i c3, __m128i alive,
+                                                              unsigned birth, unsigned survive) {
+
+    const __m128i ones = _mm_set1_epi32(-1);
+    __m128i dead = _mm_xor_si128(alive, ones);
+
+    __m128i low0 = _mm_xor_si128(_mm_or_si128(c1, c0), ones), low1 = _mm_and_si128(_mm_xor_si128(c1, ones), c0);
+    __m128i low2 = _mm_and_si128(c1, _mm_xor_si128(c0, ones)), low3 = _mm_and_si128(c1, c0);
+    __m128i high0 = _mm_xor_si128(_mm_or_si128(c3, c2), ones);
+
+    __m128i next = _mm_or_si128(BITS_TERM_SSE2(0, high0, low0), BITS_TERM_SSE2(1, high0, low1));
+    next = _mm_or_si128(next, _mm_or_si128(BITS_TERM_SSE2(2, high0, low2), BITS_TERM_SSE2(3, high0, low3)));
+    next = _mm_or_si128(next, _mm_or_si128(BITS_TERM_SSE2(4, c2, low0), BITS_TERM_SSE2(5, c2, low1)));
+    next = _mm_or_si128(next, _mm_or_si128(BITS_TERM_SSE2(6, c2, low2), BITS_TERM_SSE2(7, c2, low3)));
+
+    return _mm_or_si128(next, BITS_TERM_SSE2(8, c3, ones));
+}
+
+// same adder network as life_count(), two words at a time. births and
+// deaths are summed into two lanes with sad
+SDL_FORCE_INLINE SDL_TARGETING("sse2") void bits_rule_sse2(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words,
+                                                          unsigned birth, unsigned survive, struct life_lanes *lanes) {
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i births = zero, deaths = zero;
+    int w = 0;
+
+    if (lanes) {
+        births = _mm_loadu_si128((const __m128i *)lanes->births);
+        deaths = _mm_loadu_si128((const __m128i *)lanes->deaths);
+    }
+
+    for (; w + 2 <= words; w += 2) {
+        __m128i u = _mm_loadu_si128((const __m128i *)(up + w));
+        __m128i m = _mm_loadu_si128((const __m128i *)(mid + w));
+        __m128i d = _mm_loadu_si128((const __m128i *)(down + w));
+
+        __m128i up_w = _mm_or_si128(_mm_slli_epi64(u, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i *)(up + w - 1)), 63));
+        __m128i up_e = _mm_or_si128(_mm_srli_epi64(u, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i *)(up + w + 1)), 63));
+        __m128i mid_w = _mm_or_si128(_mm_slli_epi64(m, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i *)(mid + w - 1)), 63));
+        __m128i mid_e = _mm_or_si128(_mm_srli_epi64(m, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i *)(mid + w + 1)), 63));
+        __m128i down_w = _mm_or_si128(_mm_slli_epi64(d, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i *)(down + w - 1)), 63));
+        __m128i down_e = _mm_or_si128(_mm_srli_epi64(d, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i *)(down + w + 1)), 63));
+
+        __m128i t = _mm_xor_si128(up_w, u);
+        __m128i up0 = _mm_xor_si128(t, up_e);
+        __m128i up1 = _mm_or_si128(_mm_and_si128(up_w, u), _mm_and_si128(t, up_e));
+        t = _mm_xor_si128(down_w, d);
+        __m128i down0 = _mm_xor_si128(t, down_e);
+        __m128i down1 = _mm_or_si128(_mm_and_si128(down_w, d), _mm_and_si128(t, down_e));
+        __m128i mid0 = _mm_xor_si128(mid_w, mid_e);
+        __m128i mid1 = _mm_and_si128(mid_w, mid_e);
+
+        t = _mm_xor_si128(up0, down0);
+        __m128i c0 = _mm_xor_si128(t, mid0);
+        __m128i carry0 = _mm_or_si128(_mm_and_si128(up0, down0), _mm_and_si128(t, mid0));
+        t = _mm_xor_si128(up1, down1);
+        __m128i ones = _mm_xor_si128(t, mid1);
+        __m128i carry1 = _mm_or_si128(_mm_and_si128(up1, down1), _mm_and_si128(t, mid1));
+        __m128i c1 = _mm_xor_si128(ones, carry0);
+        __m128i c2 = _mm_xor_si128(carry1, _mm_and_si128(ones, carry0));
+        __m128i c3 = _mm_and_si128(carry1, _mm_and_si128(ones, carry0));
+
+        __m128i next = bits_apply_sse2(c0, c1, c2, c3, m, birth, survive);
+
+        _mm_storeu_si128((__m128i *)(out + w), next);
+
+        if (lanes) {
+            births = _mm_add_epi64(births, _mm_sad_epu8(bits_bytes_sse2(_mm_andnot_si128(m, next)), zero));
+            deaths = _mm_add_epi64(deaths, _mm_sad_epu8(bits_bytes_sse2(_mm_andnot_si128(next, m)), zero));
+        }
+    }
+
+    if (lanes) {
+        _mm_storeu_si128((__m128i *)lanes->births, births);
+        _mm_storeu_si128((__m128i *)lanes->deaths, deaths);
+    }
+
+    for (; w < words; w++) {
+        out[w] = rule_word(up, mid, down, w, birth, survive);
+
+        if (lanes) {
+            bits_count_word(mid[w], out[w], lanes);
+        }
+    }
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+// bits set in every byte, a nibble at a time from a table
+SDL_FORCE_INLINE SDL_TARGETING("avx2") __m256i bits_bytes_avx2(__m256i x) {
+
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    return _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+                           _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+}
+
+// rule_apply() four words at a time, RULE_TERM() with and, or and xor only
+// so constant masks fold away
+#define BITS_TERM_AVX2(n, high, low) \
+    _mm256_and_si256(_mm256_and_si256(high, low), _mm256_or_si256(_mm256_and_si256(alive, _mm256_set1_epi32(-(int)(survive >> (n) & 1))), \
+                                                     _mm256_and_si256(dead, _mm256_set1_epi32(-(int)(birth >> (n) & 1)))))
+
+SDL_FORCE_INLINE SDL_TARGETING("avx2") __m256i bits_apply_avx2(__m256i c0, __m256i c1, __m256i c2, __m256i c3, __m256i alive,
+                                                              unsigned birth, unsigned survive) {
+
+    const __m256i ones = _mm256_set1_epi32(-1);
+    __m256i dead = _mm256_xor_si256(alive, ones);
+
+    __m256i low0 = _mm256_xor_si256(_mm256_or_si256(c1, c0), ones), low1 = _mm256_and_si256(_mm256_xor_si256(c1, ones), c0);
+    __m256i low2 = _mm256_and_si256(c1, _mm256_xor_si256(c0, ones)), low3 = _mm256_and_si256(c1, c0);
+    __m256i high0 = _mm256_xor_si256(_mm256_or_si256(c3, c2), ones);
+
+    __m256i next = _mm256_or_si256(BITS_TERM_AVX2(0, high0, low0), BITS_TERM_AVX2(1, high0, low1));
+    next = _mm256_or_si256(next, _mm256_or_si256(BITS_TERM_AVX2(2, high0, low2), BITS_TERM_AVX2(3, high0, low3)));
+    next = _mm256_or_si256(next, _mm256_or_si256(BITS_TERM_AVX2(4, c2, low0), BITS_TERM_AVX2(5, c2, low1)));
+    next = _mm256_or_si256(next, _mm256_or_si256(BITS_TERM_AVX2(6, c2, low2), BITS_TERM_AVX2(7, c2, low3)));
+
+    return _mm256_or_si256(next, BITS_TERM_AVX2(8, c3, ones));
+}
+
+// same adder network as life_count(), four words at a time. births and
+// deaths are summed into four lanes with sad
+SDL_FORCE_INLINE SDL_TARGETING("avx2") void bits_rule_avx2(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words,
+                                                          unsigned birth, unsigned survive, struct life_lanes *lanes) {
+
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i births = zero, deaths = zero;
+    int w = 0;
+
+    if (lanes) {
+        births = _mm256_loadu_si256((const __m256i *)lanes->births);
+        deaths = _mm256_loadu_si256((const __m256i *)lanes->deaths);
+    }
+
+    for (; w + 4 <= words; w += 4) {
+        __m256i u = _mm256_loadu_si256((const __m256i *)(up + w));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mid + w));
+        __m256i d = _mm256_loadu_si256((const __m256i *)(down + w));
+
+        __m256i up_w = _mm256_or_si256(_mm256_slli_epi64(u, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i *)(up + w - 1)), 63));
+        __m256i up_e = _mm256_or_si256(_mm256_srli_epi64(u, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *)(up + w + 1)), 63));
+        __m256i mid_w = _mm256_or_si256(_mm256_slli_epi64(m, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i *)(mid + w - 1)), 63));
+        __m256i mid_e = _mm256_or_si256(_mm256_srli_epi64(m, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *)(mid + w + 1)), 63));
+        __m256i down_w = _mm256_or_si256(_mm256_slli_epi64(d, 1), _mm256_srli_epi64(_mm256_loadu_si256((const __m256i *)(down + w - 1)), 63));
+        __m256i down_e = _mm256_or_si256(_mm256_srli_epi64(d, 1), _mm256_slli_epi64(_mm256_loadu_si256((const __m256i *)(down + w + 1)), 63));
+
+        __m256i t = _mm256_xor_si256(up_w, u);
+        __m256i up0 = _mm256_xor_si256(t, up_e);
+        __m256i up1 = _mm256_or_si256(_mm256_and_si256(up_w, u), _mm256_and_si256(t, up_e));
+        t = _mm256_xor_si256(down_w, d);
+        __m256i down0 = _mm256_xor_si256(t, down_e);
+        __m256i down1 = _mm256_or_si256(_mm256_and_si256(down_w, d), _mm256_and_si256(t, down_e));
+        __m256i mid0 = _mm256_xor_si256(mid_w, mid_e);
+        __m256i mid1 = _mm256_and_si256(mid_w, mid_e);
+
+        t = _mm256_xor_si256(up0, down0);
+        __m256i c0 = _mm256_xor_si256(t, mid0);
+        __m256i carry0 = _mm256_or_si256(_mm256_and_si256(up0, down0), _mm256_and_si256(t, mid0));
+        t = _mm256_xor_si256(up1, down1);
+        __m256i ones = _mm256_xor_si256(t, mid1);
+        __m256i carry1 = _mm256_or_si256(_mm256_and_si256(up1, down1), _mm256_and_si256(t, mid1));
+        __m256i c1 = _mm256_xor_si256(ones, carry0);
+        __m256i c2 = _mm256_xor_si256(carry1, _mm256_and_si256(ones, carry0));
+        __m256i c3 = _mm256_and_si256(carry1, _mm256_and_si256(ones, carry0));
+
+        __m256i next = bits_apply_avx2(c0, c1, c2, c3, m, birth, survive);
+
+        _mm256_storeu_si256((__m256i *)(out + w), next);
+
+        if (lanes) {
+            births = _mm256_add_epi64(births, _mm256_sad_epu8(bits_bytes_avx2(_mm256_andnot_si256(m, next)), zero));
+            deaths = _mm256_add_epi64(deaths, _mm256_sad_epu8(bits_bytes_avx2(_mm256_andnot_si256(next, m)), zero));
+        }
+    }
+
+    if (lanes) {
+        _mm256_storeu_si256((__m256i *)lanes->births, births);
+        _mm256_storeu_si256((__m256i *)lanes->deaths, deaths);
+    }
+
+    for (; w < words; w++) {
+        out[w] = rule_word(up, mid, down, w, birth, survive);
+
+        if (lanes) {
+            bits_count_word(mid[w], out[w], lanes);
+        }
+    }
+}
+#endif
+
+// bits_row_<level>_<name>() for a rule, the masks folded in when they're
+// constants, and bits_count_<level>_<name>() that counts as well
+#define BITS_KERNEL(level, name, birth, survive) \
+    static void SDL_TARGETING(#level) bits_row_##level##_##name(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words, \
+                                                                struct life_lanes *lanes) { \
+        (void)lanes; \
+        bits_rule_##level(up, mid, down, out, words, birth, survive, NULL); \
+    } \
+    static void SDL_TARGETING(#level) bits_count_##level##_##name(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words, \
+                                                                  struct life_lanes *lanes) { \
+        bits_rule_##level(up, mid, down, out, words, birth, survive, lanes); \
+    }
+
+#define BITS_SCALAR_KERNEL(name, birth, survive) \
+    static void bits_row_scalar_##name(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words, \
+                                       struct life_lanes *lanes) { \
+        (void)lanes; \
+        bits_rule_scalar(up, mid, down, out, words, birth, survive, NULL); \
+    } \
+    static void bits_count_scalar_##name(const uint64_t *up, const uint64_t *mid, const uint64_t *down, uint64_t *out, int words, \
+                                         struct life_lanes *lanes) { \
+        bits_rule_scalar(up, mid, down, out, words, birth, survive, lanes); \
+    }
+
+#ifdef SDL_SSE2_INTRINSICS
+#define BITS_SSE2_KERNEL(name, birth, survive) BITS_KERNEL(sse2, name, birth, survive)
+#define BITS_SSE2(kind, name) bits_##kind##_sse2_##name
+#else
+#define BITS_SSE2_KERNEL(name, birth, survive)
+#define BITS_SSE2(kind, name) NULL
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+#define BITS_AVX2_KERNEL(name, birth, survive) BITS_KERNEL(avx2, name, birth, survive)
+#define BITS_AVX2(kind, name) bits_##kind##_avx2_##name
+#else
+#define BITS_AVX2_KERNEL(name, birth, survive)
+#define BITS_AVX2(kind, name) NULL
+#endif
+
+#define BITS_KERNELS(name, birth, survive) \
+    BITS_SCALAR_KERNEL(name, birth, survive) \
+    BITS_SSE2_KERNEL(name, birth, survive) \
+    BITS_AVX2_KERNEL(name, birth, survive)
+
+SPECIALIZED_RULES(BITS_KERNELS)
+BITS_KERNELS(any, rule.birth, rule.survive)
+
+static bits_kernel bits_row_kernel = bits_row_scalar_life;
+static bits_kernel bits_count_kernel = bits_count_scalar_life;
+
+// the best level the cpu has of the kernels for a rule
+static bits_kernel bits_pick_level(bits_kernel scalar, bits_kernel sse2, bits_kernel avx2) {
+
+    if (avx2 && simd_level >= SIMD_AVX2) {
+        return avx2;
+    }
+
+    if (sse2 && simd_level >= SIMD_SSE2) {
+        return sse2;
+    }
+
+    return scalar;
+}
+
+// kind is row or count
+static void bits_pick_kernels(void) {
+
+#define BITS_PICK(kind, name) bits_pick_level(bits_##kind##_scalar_##name, BITS_SSE2(kind, name), BITS_AVX2(kind, name))
+#define BITS_PICK_RULE(name, birth, survive) \
+    if (rule_is(&rule, birth, survive)) { \
+        bits_row_kernel = BITS_PICK(row, name); \
+        bits_count_kernel = BITS_PICK(count, name); \
+        return; \
+    }
+
+    SPECIALIZED_RULES(BITS_PICK_RULE)
+#undef BITS_PICK_RULE
+
+    bits_row_kernel = BITS_PICK(row, any);
+    bits_count_kernel = BITS_PICK(count, any);
+#undef BITS_PICK
+}
+
+static struct life_stats bits_stats;
+
+// the kernels count the columns past the last one as well, which are about
+// to be cleared: dead ones, or on a torus the pad bit
+static void bits_uncount_pad(const uint64_t *mid, const uint64_t *out, uint64_t last_mask, struct life_stats *band) {
+
+    uint64_t was = mid[bits_words - 1] & ~last_mask, now = out[bits_words - 1] & ~last_mask;
+
+    if (was | now) {
+        band->births -= life_popcount(now & ~was);
+        band->deaths -= life_popcount(was & ~now);
+    }
+}
+
+static void bits_band(int begin, int end, void *data) {
+
+    uint64_t last_mask = bits_last_mask();
+    struct life_lanes lanes = {0};
+    struct life_stats band = {0};
+
+    (void)data;
+
+    for (int row = begin; row < end; row++) {
+        const uint64_t *mid = bits_row(bits_cur, row);
+        uint64_t *out = bits_row(bits_next, row);
+
+        bits_count_kernel(bits_row(bits_cur, row - 1), mid, bits_row(bits_cur, row + 1), out, bits_words, &lanes);
+        bits_uncount_pad(mid, out, last_mask, &band);
+
+        // keep the columns past the last one dead
+        out[bits_words - 1] &= last_mask;
+    }
+
+    lanes_add(&band, &lanes);
+    stats_add(&bits_stats, &band);
+}
+
+// temporal blocking: with bits_block_generations above 1 a step is that many
+// generations in a single pass over the grid. every thread sweeps down its
+// band once, each generation a row behind the one before it, and keeps the
+// last three rows of the generations in between in a ring small enough to
+// stay in cache. a band is read with as many rows of halo on either side,
+// the halo shrinking by a row every generation.
+int bits_block_generations = 1;
+
+static uint64_t *bits_scratch;    // the rings of every thread
+static size_t bits_scratch_words; // allocated
+static size_t bits_scratch_share; // words of one thread
+
+// rings for blocks of k generations, 0 if out of memory
+static int bits_rings_ready(int k) {
+
+    int threads = worker_count();
+
+    // threads don't share a cache line of scratch
+    size_t line = CACHE_LINE / sizeof(uint64_t);
+    size_t share = ((size_t)3 * (k - 1) * bits_stride + line - 1) / line * line;
+
+    if (share * threads > bits_scratch_words) {
+        SDL_aligned_free(bits_scratch);
+        bits_scratch = SDL_aligned_alloc(CACHE_LINE, share * threads * sizeof(uint64_t));
+        bits_scratch_words = bits_scratch ? share * threads : 0;
+
+        if (!bits_scratch) {
+            return 0;
+        }
+    }
+
+    bits_scratch_share = share;
+
+    return 1;
+}
+
+// row of the current grid, wrapped around on a torus. dead, it can be one of
+// the pad rows
+static const uint64_t *bits_source(int row) {
+
+    if (boundary == BOUNDARY_TORUS) {
+        row = (row % bits_rows + bits_rows) % bits_rows;
+    }
+
+    return bits_row(bits_cur, row);
+}
+
+// called once for every thread, its index in begin, to step its band data
+// generations. generation 1 reads the grid, generation k writes bits_next and
+// the ones in between go through the rings
+static void bits_blocks(int begin, int end, void *data) {
+
+    int k = *(const int *)data;
+    int threads = worker_count();
+    uint64_t last_mask = bits_last_mask();
+    struct life_lanes lanes = {0};
+    struct life_stats band = {0};
+
+    for (int thread = begin; thread < end; thread++) {
+        uint64_t *scratch = bits_scratch + thread * bits_scratch_share;
+        int top = (int)((long long)bits_rows * thread / threads);
+        int bottom = (int)((long long)bits_rows * (thread + 1) / threads);
+
+        // a row of generation 1 to k - 1 in its ring, rows can be negative
+#define BITS_RING(generation, row) \
+    (scratch + ((size_t)((generation) - 1) * 3 + ((row) % 3 + 3) % 3) * bits_stride + 1)
+
+        // front is the row generation 1 is at, generation g is g - 1 rows
+        // behind it and only needs rows of generation g - 1 that are done
+        for (int front = top - k + 1; front < bottom + k - 1; front++) {
+            for (int generation = 1; generation <= k; generation++) {
+                int row = front - generation + 1;
+
+                if (row < top - (k - generation) || row >= bottom + (k - generation)) {
+                    continue;
+                }
+
+                uint64_t *out = generation == k ? bits_row(bits_next, row) : BITS_RING(generation, row);
+
+                // past a dead edge nothing ever lives
+                if (boundary == BOUNDARY_DEAD && (row < 0 || row >= bits_rows)) {
+                    SDL_memset(out - 1, 0, bits_stride * sizeof(uint64_t));
+                    continue;
+                }
+
+                const uint64_t *mid = generation == 1 ? bits_source(row) : BITS_RING(generation - 1, row);
+
+                // births and deaths are those of the last generation alone
+                bits_kernel kernel = generation == k ? bits_count_kernel : bits_row_kernel;
+
+                if (generation == 1) {
+                    kernel(bits_source(row - 1), mid, bits_source(row + 1), out, bits_words, &lanes);
+                } else {
+                    kernel(BITS_RING(generation - 1, row - 1), mid, BITS_RING(generation - 1, row + 1), out, bits_words,
+                           &lanes);
+                }
+
+                if (generation == k) {
+                    bits_uncount_pad(mid, out, last_mask, &band);
+                }
+
+                out[bits_words - 1] &= last_mask;
+
+                // the next generation reads the pads of a ring row, the
+                // grid's are taken care of by bits_step()
+                if (generation < k) {
+                    if (boundary == BOUNDARY_TORUS) {
+                        bits_wrap_row(out);
+                    } else {
+                        out[-1] = out[bits_words] = 0;
+                    }
+                } else {
+                    // so the population is counted outright
+                    for (int w = 0; w < bits_words; w++) {
+                        band.population += life_popcount(out[w]);
+                    }
+                }
+            }
+        }
+#undef BITS_RING
+    }
+
+    lanes_add(&band, &lanes);
+    stats_add(&bits_stats, &band);
+}
+
+uint64_t bits_advance(int generations) {
+
+    int k = SDL_clamp(generations, 1, MAX_BLOCK_GENERATIONS);
+
+    // the dead pads are never written
+    if (boundary == BOUNDARY_TORUS) {
+        bits_wrap(bits_cur);
+    }
+
+    uint64_t population = bits_stats.population;
+
+    bits_stats.births = bits_stats.deaths = 0;
+
+    // without the memory for blocks, one generation at a time
+    if (k > 1 && bits_rings_ready(k)) {
+        bits_stats.population = 0;
+        workers_run(bits_blocks, &k, worker_count());
+    } else {
+        k = 1;
+        workers_run(bits_band, NULL, bits_rows);
+        bits_stats.population = population + bits_stats.births - bits_stats.deaths;
+    }
+
+    uint64_t *tmp = bits_cur;
+    bits_cur = bits_next;
+    bits_next = tmp;
+
+    return k;
+}
+
+static uint64_t bits_step(void) {
+    return bits_advance(bits_block_generations);
+}
+
+static int bits_load(struct grid *grid) {
+
+    if (!bits_resize(grid->rows, grid->cols)) {
+        return 0;
+    }
+
+    bits_pick_kernels();
+    bits_stats = (struct life_stats){.counted = 1};
+
+    for (int row = 0; row < bits_rows; row++) {
+        const uint8_t *cells = grid_row(grid, row);
+        uint64_t *words = bits_row(bits_cur, row);
+
+        for (int col = 0; col < bits_cols; col++) {
+            if (1 == cells[col]) {
+                words[col / 64] |= 1ULL << (col % 64);
+                bits_stats.population++;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static void bits_store(struct grid *grid) {
+
+    for (int row = 0; row < bits_rows; row++) {
+        const uint64_t *words = bits_row(bits_cur, row);
+        uint8_t *cells = grid_row(grid, row);
+
+        for (int col = 0; col < bits_cols; col++) {
+            cells[col] = (words[col / 64] >> (col % 64)) & 1;
+        }
+    }
+}
+
+// the rows are already packed the way the digest wants them
+static uint32_t bits_digest(void) {
+    return digest_rows(bits_row(bits_cur, 0), bits_stride, bits_rows, bits_cols);
+}
+
+// a row at a time, without the torus' pad bit
+static void bits_pack(uint64_t *bits, int words) {
+
+    for (int row = 0; row < bits_rows; row++) {
+        uint64_t *out = bits + (size_t)row * words;
+
+        SDL_memcpy(out, bits_row(bits_cur, row), words * sizeof(uint64_t));
+        out[words - 1] &= bits_last_mask();
+    }
+}
+
+static void bits_get_stats(struct life_stats *stats) {
+    *stats = bits_stats;
+}
+
+const struct engine bits_engine = {"bits", bits_load, bits_step, bits_store, bits_digest, bits_pack, bits_get_stats};
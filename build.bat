@@ -1 +1,3 @@
-gcc -I src/include -L src/lib -o main main.c -lSDL3
+gcc -I src/include -L src/lib -o main main.c life.c bytelife.c bitlife.c lut.c hashlife.c sparse.c workers.c sim.c pattern.c -lSDL3_test -lSDL3
+gcc -O2 -I src/include -L src/lib -o bench bench.c life.c bytelife.c bitlife.c lut.c hashlife.c sparse.c workers.c sim.c pattern.c -lSDL3_test -lSDL3
+gcc -O2 -I src/include -L src/lib -o test test.c life.c bytelife.c bitlife.c lut.c hashlife.c sparse.c workers.c sim.c pattern.c -lSDL3_test -lSDL3
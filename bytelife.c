@@ -0,0 +1,379 @@
+#include <stdint.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_intrin.h>
+#include "life.h"
+
+// byte-per-cell engine: each cell is 0 or 1 in a uint8_t, with a border
+// column on each side and a border row above and below the grid so every
+// neighbor load stays in bounds. the border is laid out like the halo of a
+// struct grid and filled the same way.
+
+static int bytes_rows, bytes_cols;
+static size_t bytes_stride; // bytes_cols and the two border columns
+
+static uint8_t *bytes_cur;
+static uint8_t *bytes_next;
+
+// first real cell of a row
+static uint8_t *bytes_row(uint8_t *grid, int row) {
+    return grid + (row + 1) * bytes_stride + 1;
+}
+
+// both buffers for a grid of rows x cols, borders and all dead
+static int bytes_resize(int rows, int cols) {
+
+    size_t size = (size_t)(rows + 2) * (cols + 2);
+
+    if (rows != bytes_rows || cols != bytes_cols) {
+        SDL_aligned_free(bytes_cur);
+        SDL_aligned_free(bytes_next);
+        bytes_cur = SDL_aligned_alloc(CACHE_LINE, size);
+        bytes_next = SDL_aligned_alloc(CACHE_LINE, size);
+
+        if (!bytes_cur || !bytes_next) {
+            bytes_rows = bytes_cols = 0;
+            return 0;
+        }
+
+        bytes_rows = rows;
+        bytes_cols = cols;
+        bytes_stride = cols + 2;
+    }
+
+    SDL_memset(bytes_cur, 0, size);
+    SDL_memset(bytes_next, 0, size);
+
+    return 1;
+}
+
+// alive next generation when bit sum of the rule's mask for its state is
+// set, the mask picked without a branch
+SDL_FORCE_INLINE uint8_t bytes_cell(const uint8_t *up, const uint8_t *mid, const uint8_t *down, int col,
+                                    unsigned birth, unsigned survive) {
+
+    int sum = up[col - 1] + up[col] + up[col + 1]
+            + mid[col - 1] + mid[col + 1]
+            + down[col - 1] + down[col] + down[col + 1];
+
+    unsigned alive = 0u - mid[col];
+
+    return ((survive & alive) | (birth & ~alive)) >> sum & 1;
+}
+
+// one row of output cells from the three rows around it, adding the cells
+// born and died to lanes
+typedef void (*bytes_kernel)(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int cols,
+                             struct life_lanes *lanes);
+
+// the kernels are written once for any rule and compiled again for each of
+// SPECIALIZED_RULES with its masks as constants, see BYTES_KERNELS below
+SDL_FORCE_INLINE void bytes_rule_scalar(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int cols,
+                                        unsigned birth, unsigned survive, struct life_lanes *lanes) {
+
+    int born = 0, died = 0;
+
+    for (int col = 0; col < cols; col++) {
+        out[col] = bytes_cell(up, mid, down, col, birth, survive);
+        born += out[col] & ~mid[col];
+        died += mid[col] & ~out[col];
+    }
+
+    lanes->births[0] += born;
+    lanes->deaths[0] += died;
+}
+
+// the cells whose sum is n and whose state the rule turns alive, as 0xFF
+#define BYTES_TERM(level, n) \
+    level##_and(level##_cmpeq(sum, level##_set1((char)(n))), \
+                level##_or(level##_and(alive, level##_set1((char)-(int)(survive >> (n) & 1))), \
+                           level##_and(dead, level##_set1((char)-(int)(birth >> (n) & 1)))))
+
+#ifdef SDL_SSE2_INTRINSICS
+#define sse2_and _mm_and_si128
+#define sse2_or _mm_or_si128
+#define sse2_cmpeq _mm_cmpeq_epi8
+#define sse2_set1 _mm_set1_epi8
+
+// 16 cells at a time
+SDL_FORCE_INLINE SDL_TARGETING("sse2") void bytes_rule_sse2(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int cols,
+                                                           unsigned birth, unsigned survive, struct life_lanes *lanes) {
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i three = _mm_set1_epi8(3);
+    __m128i births = _mm_loadu_si128((const __m128i *)lanes->births);
+    __m128i deaths = _mm_loadu_si128((const __m128i *)lanes->deaths);
+    __m128i born = zero, died = zero;
+    int col = 0, chunk = 0;
+
+    for (; col + 16 <= cols; col += 16) {
+        __m128i m = _mm_loadu_si128((const __m128i *)(mid + col));
+
+        __m128i sum = _mm_add_epi8(_mm_loadu_si128((const __m128i *)(up + col - 1)), _mm_loadu_si128((const __m128i *)(up + col)));
+        sum = _mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(up + col + 1)));
+        sum = _mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(mid + col - 1)));
+        sum = _mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(mid + col + 1)));
+        sum = _mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(down + col - 1)));
+        sum = _mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(down + col)));
+        sum = _mm_add_epi8(sum, _mm_loadu_si128((const __m128i *)(down + col + 1)));
+
+        __m128i next;
+
+        if (birth == LIFE_BIRTH && survive == LIFE_SURVIVE) {
+            // Life's shortcut, alive when (sum | self) == 3
+            next = _mm_cmpeq_epi8(_mm_or_si128(sum, m), three);
+        } else {
+            __m128i alive = _mm_cmpeq_epi8(m, one);
+            __m128i dead = _mm_cmpeq_epi8(m, _mm_setzero_si128());
+
+            next = _mm_or_si128(BYTES_TERM(sse2, 0), BYTES_TERM(sse2, 1));
+            next = _mm_or_si128(next, _mm_or_si128(BYTES_TERM(sse2, 2), BYTES_TERM(sse2, 3)));
+            next = _mm_or_si128(next, _mm_or_si128(BYTES_TERM(sse2, 4), BYTES_TERM(sse2, 5)));
+            next = _mm_or_si128(next, _mm_or_si128(BYTES_TERM(sse2, 6), BYTES_TERM(sse2, 7)));
+            next = _mm_or_si128(next, BYTES_TERM(sse2, 8));
+        }
+
+        next = _mm_and_si128(next, one);
+        _mm_storeu_si128((__m128i *)(out + col), next);
+
+        born = _mm_add_epi8(born, _mm_andnot_si128(m, next));
+        died = _mm_add_epi8(died, _mm_andnot_si128(next, m));
+
+        // a byte adds up to 255 cells, then the bytes are summed with sad
+        if (++chunk == 255) {
+            births = _mm_add_epi64(births, _mm_sad_epu8(born, zero));
+            deaths = _mm_add_epi64(deaths, _mm_sad_epu8(died, zero));
+            born = died = zero;
+            chunk = 0;
+        }
+    }
+
+    _mm_storeu_si128((__m128i *)lanes->births, _mm_add_epi64(births, _mm_sad_epu8(born, zero)));
+    _mm_storeu_si128((__m128i *)lanes->deaths, _mm_add_epi64(deaths, _mm_sad_epu8(died, zero)));
+
+    for (; col < cols; col++) {
+        out[col] = bytes_cell(up, mid, down, col, birth, survive);
+        lanes->births[0] += out[col] & ~mid[col];
+        lanes->deaths[0] += mid[col] & ~out[col];
+    }
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+#define avx2_and _mm256_and_si256
+#define avx2_or _mm256_or_si256
+#define avx2_cmpeq _mm256_cmpeq_epi8
+#define avx2_set1 _mm256_set1_epi8
+
+// 32 cells at a time
+SDL_FORCE_INLINE SDL_TARGETING("avx2") void bytes_rule_avx2(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int cols,
+                                                           unsigned birth, unsigned survive, struct life_lanes *lanes) {
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i three = _mm256_set1_epi8(3);
+    __m256i births = _mm256_loadu_si256((const __m256i *)lanes->births);
+    __m256i deaths = _mm256_loadu_si256((const __m256i *)lanes->deaths);
+    __m256i born = zero, died = zero;
+    int col = 0, chunk = 0;
+
+    for (; col + 32 <= cols; col += 32) {
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mid + col));
+
+        __m256i sum = _mm256_add_epi8(_mm256_loadu_si256((const __m256i *)(up + col - 1)), _mm256_loadu_si256((const __m256i *)(up + col)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256((const __m256i *)(up + col + 1)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256((const __m256i *)(mid + col - 1)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256((const __m256i *)(mid + col + 1)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256((const __m256i *)(down + col - 1)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256((const __m256i *)(down + col)));
+        sum = _mm256_add_epi8(sum, _mm256_loadu_si256((const __m256i *)(down + col + 1)));
+
+        __m256i next;
+
+        if (birth == LIFE_BIRTH && survive == LIFE_SURVIVE) {
+            // Life's shortcut, alive when (sum | self) == 3
+            next = _mm256_cmpeq_epi8(_mm256_or_si256(sum, m), three);
+        } else {
+            __m256i alive = _mm256_cmpeq_epi8(m, one);
+            __m256i dead = _mm256_cmpeq_epi8(m, _mm256_setzero_si256());
+
+            next = _mm256_or_si256(BYTES_TERM(avx2, 0), BYTES_TERM(avx2, 1));
+            next = _mm256_or_si256(next, _mm256_or_si256(BYTES_TERM(avx2, 2), BYTES_TERM(avx2, 3)));
+            next = _mm256_or_si256(next, _mm256_or_si256(BYTES_TERM(avx2, 4), BYTES_TERM(avx2, 5)));
+            next = _mm256_or_si256(next, _mm256_or_si256(BYTES_TERM(avx2, 6), BYTES_TERM(avx2, 7)));
+            next = _mm256_or_si256(next, BYTES_TERM(avx2, 8));
+        }
+
+        next = _mm256_and_si256(next, one);
+        _mm256_storeu_si256((__m256i *)(out + col), next);
+
+        born = _mm256_add_epi8(born, _mm256_andnot_si256(m, next));
+        died = _mm256_add_epi8(died, _mm256_andnot_si256(next, m));
+
+        // a byte adds up to 255 cells, then the bytes are summed with sad
+        if (++chunk == 255) {
+            births = _mm256_add_epi64(births, _mm256_sad_epu8(born, zero));
+            deaths = _mm256_add_epi64(deaths, _mm256_sad_epu8(died, zero));
+            born = died = zero;
+            chunk = 0;
+        }
+    }
+
+    _mm256_storeu_si256((__m256i *)lanes->births, _mm256_add_epi64(births, _mm256_sad_epu8(born, zero)));
+    _mm256_storeu_si256((__m256i *)lanes->deaths, _mm256_add_epi64(deaths, _mm256_sad_epu8(died, zero)));
+
+    for (; col < cols; col++) {
+        out[col] = bytes_cell(up, mid, down, col, birth, survive);
+        lanes->births[0] += out[col] & ~mid[col];
+        lanes->deaths[0] += mid[col] & ~out[col];
+    }
+}
+#endif
+
+// bytes_row_<level>_<name>() for a rule, the masks folded in when they're constants
+#define BYTES_KERNEL(level, name, birth, survive) \
+    static void SDL_TARGETING(#level) bytes_row_##level##_##name(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int cols, \
+                                                                 struct life_lanes *lanes) { \
+        bytes_rule_##level(up, mid, down, out, cols, birth, survive, lanes); \
+    }
+
+#define BYTES_SCALAR_KERNEL(name, birth, survive) \
+    static void bytes_row_scalar_##name(const uint8_t *up, const uint8_t *mid, const uint8_t *down, uint8_t *out, int cols, \
+                                        struct life_lanes *lanes) { \
+        bytes_rule_scalar(up, mid, down, out, cols, birth, survive, lanes); \
+    }
+
+#ifdef SDL_SSE2_INTRINSICS
+#define BYTES_SSE2_KERNEL(name, birth, survive) BYTES_KERNEL(sse2, name, birth, survive)
+#define BYTES_SSE2(name) bytes_row_sse2_##name
+#else
+#define BYTES_SSE2_KERNEL(name, birth, survive)
+#define BYTES_SSE2(name) NULL
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+#define BYTES_AVX2_KERNEL(name, birth, survive) BYTES_KERNEL(avx2, name, birth, survive)
+#define BYTES_AVX2(name) bytes_row_avx2_##name
+#else
+#define BYTES_AVX2_KERNEL(name, birth, survive)
+#define BYTES_AVX2(name) NULL
+#endif
+
+#define BYTES_KERNELS(name, birth, survive) \
+    BYTES_SCALAR_KERNEL(name, birth, survive) \
+    BYTES_SSE2_KERNEL(name, birth, survive) \
+    BYTES_AVX2_KERNEL(name, birth, survive)
+
+SPECIALIZED_RULES(BYTES_KERNELS)
+BYTES_KERNELS(any, rule.birth, rule.survive)
+
+static bytes_kernel bytes_row_kernel = bytes_row_scalar_life;
+
+// the best level the cpu has of the kernels for a rule
+static bytes_kernel bytes_pick_level(bytes_kernel scalar, bytes_kernel sse2, bytes_kernel avx2) {
+
+    if (avx2 && simd_level >= SIMD_AVX2) {
+        return avx2;
+    }
+
+    if (sse2 && simd_level >= SIMD_SSE2) {
+        return sse2;
+    }
+
+    return scalar;
+}
+
+static bytes_kernel bytes_pick_kernel(void) {
+
+#define BYTES_PICK(name, birth, survive) \
+    if (rule_is(&rule, birth, survive)) { \
+        return bytes_pick_level(bytes_row_scalar_##name, BYTES_SSE2(name), BYTES_AVX2(name)); \
+    }
+
+    SPECIALIZED_RULES(BYTES_PICK)
+#undef BYTES_PICK
+
+    return bytes_pick_level(bytes_row_scalar_any, BYTES_SSE2(any), BYTES_AVX2(any));
+}
+
+static struct life_stats bytes_stats;
+
+static void bytes_band(int begin, int end, void *data) {
+
+    struct life_lanes lanes = {0};
+    struct life_stats band = {0};
+
+    (void)data;
+
+    for (int row = begin; row < end; row++) {
+        bytes_row_kernel(bytes_row(bytes_cur, row - 1), bytes_row(bytes_cur, row), bytes_row(bytes_cur, row + 1),
+                         bytes_row(bytes_next, row), bytes_cols, &lanes);
+    }
+
+    lanes_add(&band, &lanes);
+    stats_add(&bytes_stats, &band);
+}
+
+static uint64_t bytes_step(void) {
+
+    struct grid cur = {bytes_rows, bytes_cols, bytes_stride, bytes_cur};
+    fill_halo(&cur);
+
+    bytes_stats.births = bytes_stats.deaths = 0;
+
+    workers_run(bytes_band, NULL, bytes_rows);
+
+    uint8_t *tmp = bytes_cur;
+    bytes_cur = bytes_next;
+    bytes_next = tmp;
+
+    bytes_stats.population += bytes_stats.births - bytes_stats.deaths;
+
+    return 1;
+}
+
+static int bytes_load(struct grid *grid) {
+
+    if (!bytes_resize(grid->rows, grid->cols)) {
+        return 0;
+    }
+
+    bytes_row_kernel = bytes_pick_kernel();
+
+    for (int row = 0; row < bytes_rows; row++) {
+        // same cells as the grid, byte for byte
+        SDL_memcpy(bytes_row(bytes_cur, row), grid_row(grid, row), bytes_cols);
+    }
+
+    bytes_stats = (struct life_stats){.population = count_population(grid), .counted = 1};
+
+    return 1;
+}
+
+static void bytes_store(struct grid *grid) {
+
+    for (int row = 0; row < bytes_rows; row++) {
+        SDL_memcpy(grid_row(grid, row), bytes_row(bytes_cur, row), bytes_cols);
+    }
+}
+
+// the cells are laid out like a struct grid's
+static uint32_t bytes_digest(void) {
+
+    struct grid cells = {bytes_rows, bytes_cols, bytes_stride, bytes_cur};
+
+    return grid_digest(&cells);
+}
+
+static void bytes_pack(uint64_t *bits, int words) {
+
+    struct grid cells = {bytes_rows, bytes_cols, bytes_stride, bytes_cur};
+
+    pack_grid(&cells, bits, words);
+}
+
+static void bytes_get_stats(struct life_stats *stats) {
+    *stats = bytes_stats;
+}
+
+const struct engine bytes_engine = {"bytes", bytes_load, bytes_step, bytes_store, bytes_digest, bytes_pack, bytes_get_stats};
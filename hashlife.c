@@ -0,0 +1,472 @@
+#include <stdint.h>
+#include <SDL3/SDL_stdinc.h>
+#include "life.h"
+
+// HashLife: the universe is a quadtree of canonical nodes, every distinct
+// square of cells exists exactly once in hl_table, and each node remembers
+// its center advanced 2^hl_result_log2 generations. Repeated structure in
+// space and time is then computed only once, which lets a single step jump
+// 2^hashlife_step_log2 generations.
+//
+// unlike the flat engines the universe is unbounded, the grid is only the
+// window from (0, 0) to (cols, rows) of it, cells that leave the window keep
+// living outside of it.
+//
+// out of memory, hl_join() returns NULL and every node built from it is
+// NULL as well, up to the step, which leaves the universe as it was.
+
+#define HL_MAX_LEVEL 62
+
+struct hl_node {
+    struct hl_node *nw, *ne, *sw, *se; // quadrants, NULL for single cells
+    struct hl_node *result; // center after 2^hl_result_log2 generations
+    struct hl_node *next;   // hash chain
+    uint64_t population;
+    int level;              // the node is 2^level cells on a side
+    int marked;             // reachable, during garbage collection
+};
+
+int hashlife_step_log2 = 0;
+size_t hashlife_memory_cap = (size_t)256 << 20;
+
+static struct hl_node hl_dead = {0};
+static struct hl_node hl_alive = {.population = 1};
+
+static struct hl_node **hl_table;
+static size_t hl_buckets;
+static size_t hl_count;
+static size_t hl_grown; // nodes the last step added
+
+static struct hl_node *hl_empty[HL_MAX_LEVEL + 1];
+static struct hl_node *hl_root;
+static int hl_result_log2 = -1;
+static struct rule hl_rule; // the memoized results follow
+
+
+static size_t hl_hash(struct hl_node *nw, struct hl_node *ne, struct hl_node *sw, struct hl_node *se) {
+
+    uint64_t h = (uintptr_t)nw;
+    h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)ne;
+    h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)sw;
+    h = h * 0x9E3779B97F4A7C15ULL + (uintptr_t)se;
+
+    return (size_t)(h ^ (h >> 29));
+}
+
+static int hl_rehash(size_t buckets) {
+
+    struct hl_node **table = SDL_calloc(buckets, sizeof(*table));
+
+    if (!table) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < hl_buckets; i++) {
+        struct hl_node *node = hl_table[i];
+
+        while (node) {
+            struct hl_node *next = node->next;
+            size_t b = hl_hash(node->nw, node->ne, node->sw, node->se) & (buckets - 1);
+
+            node->next = table[b];
+            table[b] = node;
+            node = next;
+        }
+    }
+
+    SDL_free(hl_table);
+    hl_table = table;
+    hl_buckets = buckets;
+
+    return 1;
+}
+
+// the one node with these four quadrants, NULL if any of them is
+static struct hl_node *hl_join(struct hl_node *nw, struct hl_node *ne, struct hl_node *sw, struct hl_node *se) {
+
+    if (!nw || !ne || !sw || !se) {
+        return NULL;
+    }
+
+    size_t b = hl_hash(nw, ne, sw, se) & (hl_buckets - 1);
+
+    for (struct hl_node *node = hl_table[b]; node; node = node->next) {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se) {
+            return node;
+        }
+    }
+
+    struct hl_node *node = SDL_malloc(sizeof(*node));
+
+    if (!node) {
+        return NULL;
+    }
+
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->result = NULL;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->level = nw->level + 1;
+    node->marked = 0;
+
+    node->next = hl_table[b];
+    hl_table[b] = node;
+    hl_count++;
+
+    if (hl_count > hl_buckets) {
+        hl_rehash(hl_buckets * 2);
+    }
+
+    return node;
+}
+
+static struct hl_node *hl_empty_node(int level) {
+
+    if (level == 0) {
+        return &hl_dead;
+    }
+
+    if (!hl_empty[level]) {
+        struct hl_node *e = hl_empty_node(level - 1);
+        hl_empty[level] = hl_join(e, e, e, e);
+    }
+
+    return hl_empty[level];
+}
+
+// the node one level down, centered on this one
+static struct hl_node *hl_center(struct hl_node *n) {
+
+    if (!n) {
+        return NULL;
+    }
+
+    return hl_join(n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
+
+// the same cells in a node twice as wide, padded with dead cells. NULL
+// past HL_MAX_LEVEL, a step that would need it fails like one out of memory
+static struct hl_node *hl_expand(struct hl_node *n) {
+
+    if (!n || n->level >= HL_MAX_LEVEL) {
+        return NULL;
+    }
+
+    struct hl_node *e = hl_empty_node(n->level - 1);
+
+    return hl_join(hl_join(e, e, e, n->nw), hl_join(e, e, n->ne, e),
+                   hl_join(e, n->sw, e, e), hl_join(n->se, e, e, e));
+}
+
+
+// one generation of the center 2x2 of a 4x4 node, from the lut engine's table
+static struct hl_node *hl_base_case(struct hl_node *n) {
+
+    // bit y * 4 + x is the cell at (x, y) of the 4x4 square
+    unsigned index = 0;
+    struct hl_node *quads[2][2] = {{n->nw, n->ne}, {n->sw, n->se}};
+
+    for (int qy = 0; qy < 2; qy++) {
+        for (int qx = 0; qx < 2; qx++) {
+            struct hl_node *q = quads[qy][qx];
+            int bit = qy * 8 + qx * 2;
+
+            index |= (unsigned)q->nw->population << bit;
+            index |= (unsigned)q->ne->population << (bit + 1);
+            index |= (unsigned)q->sw->population << (bit + 4);
+            index |= (unsigned)q->se->population << (bit + 5);
+        }
+    }
+
+    unsigned next = life_table[index];
+
+    return hl_join(next & 1 ? &hl_alive : &hl_dead, next & 2 ? &hl_alive : &hl_dead,
+                   next & 4 ? &hl_alive : &hl_dead, next & 8 ? &hl_alive : &hl_dead);
+}
+
+// center of a level k node advanced 2^min(hl_result_log2, k - 2) generations
+static struct hl_node *hl_successor(struct hl_node *n) {
+
+    if (!n) {
+        return NULL;
+    }
+
+    if (n->result) {
+        return n->result;
+    }
+
+    if (n->population == 0) {
+        return n->result = hl_empty_node(n->level - 1);
+    }
+
+    if (n->level == 2) {
+        return n->result = hl_base_case(n);
+    }
+
+    // the nine overlapping half-size nodes
+    struct hl_node *n00 = n->nw;
+    struct hl_node *n01 = hl_join(n->nw->ne, n->ne->nw, n->nw->se, n->ne->sw);
+    struct hl_node *n02 = n->ne;
+    struct hl_node *n10 = hl_join(n->nw->sw, n->nw->se, n->sw->nw, n->sw->ne);
+    struct hl_node *n11 = hl_center(n);
+    struct hl_node *n12 = hl_join(n->ne->sw, n->ne->se, n->se->nw, n->se->ne);
+    struct hl_node *n20 = n->sw;
+    struct hl_node *n21 = hl_join(n->sw->ne, n->se->nw, n->sw->se, n->se->sw);
+    struct hl_node *n22 = n->se;
+
+    // full speed advances both halves, slower steps only the second one
+    struct hl_node *(*first)(struct hl_node *) = hl_result_log2 >= n->level - 2 ? hl_successor : hl_center;
+
+    struct hl_node *r00 = first(n00), *r01 = first(n01), *r02 = first(n02);
+    struct hl_node *r10 = first(n10), *r11 = first(n11), *r12 = first(n12);
+    struct hl_node *r20 = first(n20), *r21 = first(n21), *r22 = first(n22);
+
+    n->result = hl_join(hl_successor(hl_join(r00, r01, r10, r11)),
+                        hl_successor(hl_join(r01, r02, r11, r12)),
+                        hl_successor(hl_join(r10, r11, r20, r21)),
+                        hl_successor(hl_join(r11, r12, r21, r22)));
+
+    return n->result;
+}
+
+
+static void hl_mark(struct hl_node *n) {
+
+    if (n->level == 0 || n->marked) {
+        return;
+    }
+
+    n->marked = 1;
+    hl_mark(n->nw);
+    hl_mark(n->ne);
+    hl_mark(n->sw);
+    hl_mark(n->se);
+}
+
+// free every node the universe no longer reaches, memoized results of the
+// survivors that pointed at freed nodes are forgotten
+static void hl_collect(void) {
+
+    hl_mark(hl_root);
+
+    for (int level = 1; level <= HL_MAX_LEVEL; level++) {
+        if (hl_empty[level]) {
+            hl_mark(hl_empty[level]);
+        }
+    }
+
+    for (size_t i = 0; i < hl_buckets; i++) {
+        for (struct hl_node *node = hl_table[i]; node; node = node->next) {
+            if (node->marked && node->result && !node->result->marked) {
+                node->result = NULL;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < hl_buckets; i++) {
+        struct hl_node **link = &hl_table[i];
+
+        while (*link) {
+            struct hl_node *node = *link;
+
+            if (node->marked) {
+                node->marked = 0;
+                link = &node->next;
+            } else {
+                *link = node->next;
+                SDL_free(node);
+                hl_count--;
+            }
+        }
+    }
+}
+
+size_t hashlife_memory_used(void) {
+    return hl_count * sizeof(struct hl_node) + hl_buckets * sizeof(struct hl_node *);
+}
+
+// results are memoized for one step size, forget them when it changes
+static void hl_forget_results(void) {
+
+    for (size_t i = 0; i < hl_buckets; i++) {
+        for (struct hl_node *node = hl_table[i]; node; node = node->next) {
+            node->result = NULL;
+        }
+    }
+}
+
+
+// down to the cap, giving up the memoized results as well if collecting
+// alone isn't enough
+static void hl_shrink(size_t cap) {
+
+    hl_collect();
+
+    if (hashlife_memory_used() > cap) {
+        hl_forget_results();
+        hl_collect();
+    }
+}
+
+// the root advanced 2^hl_result_log2 generations, NULL out of memory
+static struct hl_node *hl_advance_root(int log2_generations) {
+
+    // live cells must sit in the middle quarter so nothing can reach past
+    // the successor's edge in 2^log2_generations steps
+    struct hl_node *root = hl_root;
+
+    while (root && root->level < log2_generations + 3) {
+        root = hl_expand(root);
+    }
+
+    for (;;) {
+        struct hl_node *inner = hl_center(hl_center(root));
+
+        if (!inner || inner->population == root->population) {
+            return inner ? hl_successor(root) : NULL;
+        }
+
+        root = hl_expand(root);
+    }
+}
+
+uint64_t hashlife_advance(int log2_generations) {
+
+    if (log2_generations < 0 || log2_generations > HL_MAX_LEVEL - 3) {
+        return 0;
+    }
+
+    if (hl_result_log2 != log2_generations) {
+        hl_forget_results();
+        hl_result_log2 = log2_generations;
+    }
+
+    // make room first when the step is likely to grow as much as the last one
+    if (hashlife_memory_used() + hl_grown * sizeof(struct hl_node) > hashlife_memory_cap) {
+        hl_shrink(hashlife_memory_cap);
+    }
+
+    size_t count = hl_count;
+    struct hl_node *next = hl_advance_root(log2_generations);
+
+    // out of memory, try again with only the universe itself left
+    if (!next) {
+        hl_shrink(0);
+        count = hl_count;
+        next = hl_advance_root(log2_generations);
+    }
+
+    if (!next) {
+        hl_collect();
+        return 0;
+    }
+
+    hl_root = next;
+    hl_grown = hl_count > count ? hl_count - count : 0;
+
+    if (hashlife_memory_used() > hashlife_memory_cap) {
+        hl_shrink(hashlife_memory_cap);
+    }
+
+    return (uint64_t)1 << log2_generations;
+}
+
+
+// the square at (x, y) of the flat grid, 2^level cells on a side
+static struct hl_node *hl_build(const struct grid *grid, int level, int64_t x, int64_t y) {
+
+    int64_t size = (int64_t)1 << level;
+
+    if (x >= grid->cols || y >= grid->rows || x + size <= 0 || y + size <= 0) {
+        return hl_empty_node(level);
+    }
+
+    if (level == 0) {
+        return get_point(grid, (int)y, (int)x) ? &hl_alive : &hl_dead;
+    }
+
+    int64_t half = size / 2;
+
+    return hl_join(hl_build(grid, level - 1, x, y), hl_build(grid, level - 1, x + half, y),
+                   hl_build(grid, level - 1, x, y + half), hl_build(grid, level - 1, x + half, y + half));
+}
+
+// write the live cells of a node at (x, y) that fall inside the flat grid
+static void hl_fill(struct grid *grid, struct hl_node *n, int64_t x, int64_t y) {
+
+    int64_t size = (int64_t)1 << n->level;
+
+    if (n->population == 0 || x >= grid->cols || y >= grid->rows || x + size <= 0 || y + size <= 0) {
+        return;
+    }
+
+    if (n->level == 0) {
+        set_point(grid, (int)y, (int)x, 1);
+        return;
+    }
+
+    int64_t half = size / 2;
+
+    hl_fill(grid, n->nw, x, y);
+    hl_fill(grid, n->ne, x + half, y);
+    hl_fill(grid, n->sw, x, y + half);
+    hl_fill(grid, n->se, x + half, y + half);
+}
+
+static int hashlife_load(struct grid *grid) {
+
+    if (!hl_table && !hl_rehash(1 << 16)) {
+        return 0;
+    }
+
+    // results under another rule are no good anymore
+    if (!rule_is(&hl_rule, rule.birth, rule.survive)) {
+        hl_forget_results();
+        hl_rule = rule;
+    }
+
+    init_life_table();
+
+    // smallest root centered on the origin that covers the grid
+    int level = 1;
+    while (((int64_t)1 << (level - 1)) < grid->rows || ((int64_t)1 << (level - 1)) < grid->cols) {
+        level++;
+    }
+
+    int64_t half = (int64_t)1 << (level - 1);
+
+    struct hl_node *root = hl_join(hl_build(grid, level - 1, -half, -half), hl_build(grid, level - 1, 0, -half),
+                                   hl_build(grid, level - 1, -half, 0), hl_build(grid, level - 1, 0, 0));
+
+    if (!root) {
+        return 0;
+    }
+
+    hl_root = root;
+    hl_grown = 0;
+    hl_collect();
+
+    return 1;
+}
+
+static uint64_t hashlife_step(void) {
+    return hashlife_advance(hashlife_step_log2);
+}
+
+static void hashlife_store(struct grid *grid) {
+
+    reset_all_points(grid);
+
+    int64_t half = (int64_t)1 << (hl_root->level - 1);
+
+    hl_fill(grid, hl_root, -half, -half);
+}
+
+// every node knows its population, births and deaths are lost in the jump
+static void hashlife_stats(struct life_stats *stats) {
+    *stats = (struct life_stats){.population = hl_root->population};
+}
+
+const struct engine hashlife_engine = {"hashlife", hashlife_load, hashlife_step, hashlife_store, NULL, NULL, hashlife_stats};
@@ -0,0 +1,667 @@
+#include <string.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include <SDL3/SDL_endian.h>
+#include <SDL3/SDL_intrin.h>
+#include <SDL3/SDL_test_crc32.h>
+#include "life.h"
+
+
+// the naive engine's grid, its second buffer and block flags
+static struct grid *naive_grid;
+static struct grid points_back;
+
+// which blocks changed in the last generation, and in the one being computed
+static unsigned char *block_flags[2];
+static int block_rows, block_cols;
+
+int blocks_skipped;
+uint64_t points_births, points_deaths;
+
+
+int init_points(struct grid *grid, int rows, int cols) {
+
+    free_points(grid);
+
+    if (rows < 1 || cols < 1 || rows > MAX_GRID_SIZE || cols > MAX_GRID_SIZE) {
+        return 0;
+    }
+
+    // every row and its two halo cells on their own cache lines
+    grid->rows = rows;
+    grid->cols = cols;
+    grid->stride = ((size_t)cols + 2 + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    grid->cells = SDL_aligned_alloc(CACHE_LINE, grid->stride * (rows + 2));
+
+    if (!grid->cells) {
+        free_points(grid);
+        return 0;
+    }
+
+    reset_all_points(grid);
+    init_digest();
+
+    return 1;
+}
+
+
+void free_points(struct grid *grid) {
+
+    SDL_aligned_free(grid->cells);
+    grid->cells = NULL;
+    grid->rows = grid->cols = 0;
+    grid->stride = 0;
+}
+
+
+// next state of the cell at col of the mid row. the halo stands in for
+// whatever is past the edges, so there's nothing to bounds check, and the
+// rule is a lookup: masks[0] is the birth mask, masks[1] the survive mask.
+static uint8_t next_point_state(const uint8_t *up, const uint8_t *mid, const uint8_t *down, int col, const uint16_t masks[2]) {
+
+    int total_alive_neighbors = up[col - 1] + up[col] + up[col + 1]
+                              + mid[col - 1] + mid[col + 1]
+                              + down[col - 1] + down[col] + down[col + 1];
+
+    return masks[mid[col]] >> total_alive_neighbors & 1;
+}
+
+
+struct rule rule = {LIFE_BIRTH, LIFE_SURVIVE};
+
+struct rule_name {
+    const char *name;
+    struct rule rule;
+};
+
+static const struct rule_name rule_names[] = {
+#define RULE_NAME(name, birth, survive) {#name, {birth, survive}},
+    SPECIALIZED_RULES(RULE_NAME)
+#undef RULE_NAME
+    {NULL, {0, 0}}
+};
+
+// B and S each followed by their neighbor counts, in either order, with
+// or without a slash between them
+int parse_rule(const char *text, struct rule *parsed) {
+
+    for (int i = 0; rule_names[i].name; i++) {
+        if (SDL_strcasecmp(text, rule_names[i].name) == 0) {
+            *parsed = rule_names[i].rule;
+            return 1;
+        }
+    }
+
+    uint16_t *mask = NULL;
+    int seen = 0;
+
+    parsed->birth = parsed->survive = 0;
+
+    for (const char *p = text; *p; p++) {
+        if (*p == 'B' || *p == 'b') {
+            mask = &parsed->birth;
+            seen |= 1;
+        } else if (*p == 'S' || *p == 's') {
+            mask = &parsed->survive;
+            seen |= 2;
+        } else if (*p >= '0' && *p <= '8' && mask) {
+            *mask |= 1 << (*p - '0');
+        } else if (*p != '/' || !mask) {
+            return 0;
+        }
+    }
+
+    return seen == 3;
+}
+
+void format_rule(const struct rule *r, char *text, size_t size) {
+
+    char digits[2][10];
+
+    for (int m = 0; m < 2; m++) {
+        unsigned mask = m ? r->survive : r->birth;
+        int n = 0;
+
+        for (int i = 0; i <= 8; i++) {
+            if (mask >> i & 1) {
+                digits[m][n++] = (char)('0' + i);
+            }
+        }
+
+        digits[m][n] = '\0';
+    }
+
+    SDL_snprintf(text, size, "B%s/S%s", digits[0], digits[1]);
+}
+
+int rule_is(const struct rule *r, unsigned birth, unsigned survive) {
+    return r->birth == birth && r->survive == survive;
+}
+
+
+enum boundary boundary = BOUNDARY_DEAD;
+
+const char *boundary_names[] = {"dead", "torus"};
+
+void fill_halo(struct grid *grid) {
+
+    int rows = grid->rows, cols = grid->cols;
+
+    if (boundary == BOUNDARY_DEAD) {
+        SDL_memset(grid_row(grid, -1) - 1, 0, cols + 2);
+        SDL_memset(grid_row(grid, rows) - 1, 0, cols + 2);
+
+        for (int row = 0; row < rows; row++) {
+            uint8_t *cells = grid_row(grid, row);
+            cells[-1] = cells[cols] = 0;
+        }
+        return;
+    }
+
+    // the columns first so the corners come along with the rows
+    for (int row = 0; row < rows; row++) {
+        uint8_t *cells = grid_row(grid, row);
+        cells[-1] = cells[cols - 1];
+        cells[cols] = cells[0];
+    }
+
+    SDL_memcpy(grid_row(grid, -1) - 1, grid_row(grid, rows - 1) - 1, cols + 2);
+    SDL_memcpy(grid_row(grid, rows) - 1, grid_row(grid, 0) - 1, cols + 2);
+}
+
+
+// a block has to be recomputed only if it or one of its neighbors changed
+// last generation, everything else is still the same in the back buffer. on
+// a torus the blocks along opposite edges are neighbors.
+static int block_active(int block_row, int block_col) {
+
+    int wrap = boundary == BOUNDARY_TORUS;
+
+    for (int r = block_row - 1; r <= block_row + 1; r++) {
+        for (int c = block_col - 1; c <= block_col + 1; c++) {
+            int wr = wrap ? (r + block_rows) % block_rows : r;
+            int wc = wrap ? (c + block_cols) % block_cols : c;
+
+            if (wr >= 0 && wr < block_rows && wc >= 0 && wc < block_cols && block_flags[0][wr * block_cols + wc]) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+// update points
+void update_points(struct grid *grid) {
+
+    const uint16_t masks[2] = {rule.birth, rule.survive};
+
+    blocks_skipped = 0;
+    points_births = points_deaths = 0;
+
+    fill_halo(grid);
+
+    for (int block_row = 0; block_row < block_rows; block_row++) {
+        for (int block_col = 0; block_col < block_cols; block_col++) {
+            unsigned char *changed_next = &block_flags[1][block_row * block_cols + block_col];
+
+            if (!block_active(block_row, block_col)) {
+                *changed_next = 0;
+                blocks_skipped++;
+                continue;
+            }
+
+            int born = 0, died = 0;
+
+            int row_end = SDL_min((block_row + 1) * BLOCK_SIZE, grid->rows);
+            int col_end = SDL_min((block_col + 1) * BLOCK_SIZE, grid->cols);
+
+            for (int row = block_row * BLOCK_SIZE; row < row_end; row++) {
+                const uint8_t *up = grid_row(grid, row - 1);
+                const uint8_t *mid = grid_row(grid, row);
+                const uint8_t *down = grid_row(grid, row + 1);
+                uint8_t *back = grid_row(&points_back, row);
+
+                for (int col = block_col * BLOCK_SIZE; col < col_end; col++) {
+                    uint8_t next = next_point_state(up, mid, down, col, masks);
+
+                    back[col] = next;
+                    born += next & ~mid[col];
+                    died += mid[col] & ~next;
+                }
+            }
+
+            *changed_next = born || died;
+            points_births += born;
+            points_deaths += died;
+        }
+    }
+
+    // the new generation becomes the front buffer
+    uint8_t *tmp = grid->cells;
+    grid->cells = points_back.cells;
+    points_back.cells = tmp;
+
+    unsigned char *flags = block_flags[0];
+    block_flags[0] = block_flags[1];
+    block_flags[1] = flags;
+}
+
+
+void mark_all_points_changed(void) {
+    SDL_memset(block_flags[0], 1, (size_t)block_rows * block_cols);
+}
+
+
+void reset_all_points(struct grid *grid) {
+    SDL_memset(grid->cells, 0, grid->stride * (grid->rows + 2));
+}
+
+uint64_t count_population(const struct grid *grid) {
+
+    uint64_t population = 0;
+
+    for (int row = 0; row < grid->rows; row++) {
+        const uint8_t *cells = grid_row(grid, row);
+
+        for (int col = 0; col < grid->cols; col++) {
+            population += cells[col];
+        }
+    }
+
+    return population;
+}
+
+// CRC32 of the grid packed 8 cells to a byte, row after row: bit b of byte
+// i of a row is column 8 * i + b. the same generation digests the same in
+// every engine, kernel level and thread count.
+static SDLTest_Crc32Context digest_context;
+
+int log_digests;
+
+void init_digest(void) {
+    SDLTest_Crc32Init(&digest_context);
+}
+
+// bytes are packed into a small buffer and fed to the CRC a chunk at a time
+#define DIGEST_CHUNK 256
+
+static void digest_row(const uint64_t *words, int cols, CrcUint32 *crc) {
+
+    CrcUint8 bytes[DIGEST_CHUNK];
+    int count = (cols + 7) / 8;
+
+    for (int first = 0; first < count; first += DIGEST_CHUNK) {
+        int n = SDL_min(count - first, DIGEST_CHUNK);
+
+        for (int i = 0; i < n; i++) {
+            bytes[i] = (CrcUint8)(words[(first + i) / 8] >> ((first + i) % 8 * 8));
+        }
+
+        // columns past the edge don't count
+        if (first + n == count && cols % 8) {
+            bytes[n - 1] &= (1 << (cols % 8)) - 1;
+        }
+
+        SDLTest_Crc32CalcBuffer(&digest_context, bytes, n, crc);
+    }
+}
+
+uint32_t digest_rows(const uint64_t *rows, size_t stride, int count, int cols) {
+
+    CrcUint32 crc;
+
+    SDLTest_Crc32CalcStart(&digest_context, &crc);
+
+    for (int row = 0; row < count; row++) {
+        digest_row(rows + row * stride, cols, &crc);
+    }
+
+    SDLTest_Crc32CalcEnd(&digest_context, &crc);
+
+    return crc;
+}
+
+uint32_t grid_digest(const struct grid *grid) {
+
+    CrcUint8 bytes[DIGEST_CHUNK];
+    CrcUint32 crc;
+
+    SDLTest_Crc32CalcStart(&digest_context, &crc);
+
+    for (int row = 0; row < grid->rows; row++) {
+        const uint8_t *cells = grid_row(grid, row);
+        int n = 0;
+
+        for (int col = 0; col < grid->cols; col += 8) {
+            CrcUint8 byte = 0;
+
+            for (int b = 0; b < 8 && col + b < grid->cols; b++) {
+                byte |= cells[col + b] << b;
+            }
+
+            bytes[n++] = byte;
+
+            if (n == DIGEST_CHUNK) {
+                SDLTest_Crc32CalcBuffer(&digest_context, bytes, n, &crc);
+                n = 0;
+            }
+        }
+
+        if (n) {
+            SDLTest_Crc32CalcBuffer(&digest_context, bytes, n, &crc);
+        }
+    }
+
+    SDLTest_Crc32CalcEnd(&digest_context, &crc);
+
+    return crc;
+}
+
+void pack_grid(const struct grid *grid, uint64_t *bits, int words) {
+
+    for (int row = 0; row < grid->rows; row++) {
+        const uint8_t *cells = grid_row(grid, row);
+        uint64_t *out = bits + (size_t)row * words;
+
+        int col = 0;
+
+        for (int w = 0; w < words; w++) {
+            out[w] = 0;
+        }
+
+        // 8 cells at a time, the multiply gathers the low bit of every
+        // byte into the top one
+        for (; col + 8 <= grid->cols; col += 8) {
+            uint64_t eight;
+
+            SDL_memcpy(&eight, cells + col, sizeof(eight));
+            out[col / 64] |= (SDL_Swap64LE(eight) * 0x0102040810204080ULL >> 56) << (col % 64);
+        }
+
+        for (; col < grid->cols; col++) {
+            out[col / 64] |= (uint64_t)cells[col] << (col % 64);
+        }
+    }
+}
+
+void engine_pack(const struct engine *engine, struct grid *grid, uint64_t *bits, int words) {
+
+    if (engine->pack) {
+        engine->pack(bits, words);
+        return;
+    }
+
+    engine->store(grid);
+    pack_grid(grid, bits, words);
+}
+
+uint32_t engine_digest(const struct engine *engine, struct grid *grid) {
+
+    if (engine->digest) {
+        return engine->digest();
+    }
+
+    engine->store(grid);
+
+    return grid_digest(grid);
+}
+
+// the unbounded engines only show the grid as a window into the universe,
+// which can turn periodic while things are still going on outside it
+int engine_bounded(const struct engine *engine) {
+    return engine != &hashlife_engine && engine != &sparse_engine;
+}
+
+// the engines that step several generations at once take a shorter step
+// when a run has to end on an exact generation, or the cycle detector
+// wants every one
+uint64_t engine_step_within(const struct engine *engine, uint64_t limit) {
+
+    if (engine == &bits_engine && (uint64_t)bits_block_generations > limit) {
+        return bits_advance((int)limit);
+    }
+
+    // the longest jump that fits
+    if (engine == &hashlife_engine && ((uint64_t)1 << hashlife_step_log2) > limit) {
+        int log2 = 0;
+
+        while (((uint64_t)2 << log2) <= limit) {
+            log2++;
+        }
+
+        return hashlife_advance(log2);
+    }
+
+    return engine->step();
+}
+
+
+int detect_cycles = 1;
+
+void cycle_reset(struct cycle *cycle) {
+    SDL_memset(cycle, 0, sizeof(*cycle));
+}
+
+int cycle_update(struct cycle *cycle, uint64_t generation, uint32_t digest) {
+
+    if (cycle->period) {
+        return 1;
+    }
+
+    // the grid repeats after the multiple, so the first time it's back is
+    // after a divisor of it
+    if (cycle->multiple) {
+        uint64_t since = generation - cycle->anchor;
+
+        if (since >= cycle->multiple || (digest == cycle->anchor_digest && cycle->multiple % since == 0)) {
+            cycle->period = SDL_min(since, cycle->multiple);
+            return 1;
+        }
+
+        return 0;
+    }
+
+    uint64_t last = cycle->count ? cycle->generations[(cycle->next - 1 + CYCLE_HISTORY) % CYCLE_HISTORY] : generation;
+
+    // the newest earlier generation that digested the same, preferring the
+    // period being confirmed
+    uint64_t period = 0;
+
+    for (int i = 1; i <= cycle->count; i++) {
+        int at = (cycle->next - i + CYCLE_HISTORY) % CYCLE_HISTORY;
+
+        if (cycle->digests[at] != digest) {
+            continue;
+        }
+
+        uint64_t p = generation - cycle->generations[at];
+
+        if (!period || p == cycle->candidate) {
+            period = p;
+        }
+
+        if (p == cycle->candidate) {
+            break;
+        }
+    }
+
+    cycle->generations[cycle->next] = generation;
+    cycle->digests[cycle->next] = digest;
+    cycle->next = (cycle->next + 1) % CYCLE_HISTORY;
+    cycle->count = SDL_min(cycle->count + 1, CYCLE_HISTORY);
+
+    if (period != cycle->candidate) {
+        cycle->candidate = period;
+        cycle->since = generation;
+    }
+
+    // one match would do if digests never collided
+    if (period && generation - cycle->since >= period) {
+        cycle->start = cycle->since - period;
+
+        // seen every few generations
+        if (generation - last > 1) {
+            cycle->multiple = period;
+            cycle->anchor = generation;
+            cycle->anchor_digest = digest;
+            return 0;
+        }
+
+        cycle->period = period;
+        return 1;
+    }
+
+    return 0;
+}
+
+int cycle_due(const struct cycle *cycle, uint64_t generation) {
+
+    if (cycle->multiple || !cycle->count) {
+        return 1;
+    }
+
+    return generation - cycle->generations[(cycle->next - 1 + CYCLE_HISTORY) % CYCLE_HISTORY] >= CYCLE_INTERVAL;
+}
+
+
+static struct life_stats naive_stats;
+
+// the reference engine works on the grid itself, it only needs a second
+// buffer of the same size and has to forget which blocks were settled since
+// the cells may have been edited
+static int naive_load(struct grid *grid) {
+
+    if (points_back.rows != grid->rows || points_back.cols != grid->cols) {
+        SDL_free(block_flags[0]);
+        SDL_free(block_flags[1]);
+
+        block_rows = (grid->rows + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        block_cols = (grid->cols + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        block_flags[0] = SDL_calloc((size_t)block_rows * block_cols, 1);
+        block_flags[1] = SDL_calloc((size_t)block_rows * block_cols, 1);
+
+        if (!block_flags[0] || !block_flags[1] || !init_points(&points_back, grid->rows, grid->cols)) {
+            free_points(&points_back);
+            return 0;
+        }
+    }
+
+    naive_grid = grid;
+    naive_stats = (struct life_stats){.population = count_population(grid), .counted = 1};
+    mark_all_points_changed();
+
+    return 1;
+}
+
+static uint64_t naive_step(void) {
+
+    update_points(naive_grid);
+
+    naive_stats.births = points_births;
+    naive_stats.deaths = points_deaths;
+    naive_stats.population += points_births - points_deaths;
+
+    return 1;
+}
+
+static void naive_store(struct grid *grid) {
+    (void)grid;
+}
+
+static uint32_t naive_digest(void) {
+    return grid_digest(naive_grid);
+}
+
+static void naive_get_stats(struct life_stats *stats) {
+    *stats = naive_stats;
+}
+
+static void naive_pack(uint64_t *bits, int words) {
+    pack_grid(naive_grid, bits, words);
+}
+
+const struct engine naive_engine = {"naive", naive_load, naive_step, naive_store, naive_digest, naive_pack, naive_get_stats};
+
+const struct engine *engines[] = {&naive_engine, &bytes_engine, &bits_engine, &lut_engine, &hashlife_engine, &sparse_engine, NULL};
+
+void engine_status(const struct engine *engine, char *text, size_t size) {
+
+    if (engine == &naive_engine) {
+        SDL_snprintf(text, size, "skipped %d/%d blocks", blocks_skipped, block_rows * block_cols);
+    } else if (engine == &hashlife_engine) {
+        SDL_snprintf(text, size, "nodes %zu KiB", hashlife_memory_used() >> 10);
+    } else if (engine == &sparse_engine) {
+        SDL_snprintf(text, size, "tiles %d", sparse_tile_count());
+    } else {
+        SDL_snprintf(text, size, "%s", simd_names[simd_level]);
+    }
+}
+
+static SDL_SpinLock stats_lock;
+
+void stats_add(struct life_stats *stats, const struct life_stats *band) {
+
+    SDL_LockSpinlock(&stats_lock);
+    stats->population += band->population;
+    stats->births += band->births;
+    stats->deaths += band->deaths;
+    SDL_UnlockSpinlock(&stats_lock);
+}
+
+int log_stats;
+
+void stats_reset(struct stats_history *history) {
+    history->count = history->next = 0;
+}
+
+void stats_record(struct stats_history *history, const struct life_stats *stats) {
+
+    history->entries[history->next] = *stats;
+    history->next = (history->next + 1) % STATS_HISTORY;
+    history->count = SDL_min(history->count + 1, STATS_HISTORY);
+}
+
+const struct life_stats *stats_at(const struct stats_history *history, int age) {
+
+    if (age < 0 || age >= history->count) {
+        return NULL;
+    }
+
+    return &history->entries[(history->next - 1 - age + STATS_HISTORY) % STATS_HISTORY];
+}
+
+const struct engine *find_engine(const char *name) {
+
+    for (int i = 0; engines[i]; i++) {
+        if (strcmp(engines[i]->name, name) == 0) {
+            return engines[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+enum simd_level simd_level = SIMD_SCALAR;
+
+const char *simd_names[] = {"scalar", "sse2", "avx2"};
+
+enum simd_level detect_simd(void) {
+
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        return SIMD_AVX2;
+    }
+#endif
+
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        return SIMD_SSE2;
+    }
+#endif
+
+    return SIMD_SCALAR;
+}
@@ -0,0 +1,392 @@
+#ifndef LIFE_H
+#define LIFE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCREEN_WIDTH 1200
+#define SCREEN_HEIGHT 800
+
+// without -x and -y the grid is the window divided into cells, builds can
+// pick another default with -DCELL_SIZE=n
+#ifndef CELL_SIZE
+#define CELL_SIZE 18
+#endif
+#define DEFAULT_ROWS (SCREEN_HEIGHT / CELL_SIZE)
+#define DEFAULT_COLS (SCREEN_WIDTH / CELL_SIZE)
+
+#define MAX_GRID_SIZE (1 << 20) // rows or columns
+
+#define CACHE_LINE 64
+
+// the cells, one byte each, 0 is dead and 1 is alive, rows stride bytes
+// apart. around them is a one cell halo, rows -1 and rows and columns -1 and
+// cols, which update_points() fills from the boundary before every
+// generation. the engines work on whole rows, everything else goes through
+// get_point() and set_point().
+struct grid {
+    int rows, cols;
+    size_t stride;
+    uint8_t *cells;
+};
+
+static inline uint8_t *grid_row(const struct grid *grid, int row) {
+    return grid->cells + (size_t)(row + 1) * grid->stride + 1;
+}
+
+static inline int get_point(const struct grid *grid, int row, int col) {
+    return grid_row(grid, row)[col];
+}
+
+static inline void set_point(struct grid *grid, int row, int col, int state) {
+    grid_row(grid, row)[col] = (uint8_t)state;
+}
+
+int init_points(struct grid *grid, int rows, int cols); // all dead, 0 if out of memory
+void free_points(struct grid *grid);
+void reset_all_points(struct grid *grid);
+
+uint64_t count_population(const struct grid *grid);
+
+// a Life-like rule: bit n of birth is set when a dead cell with n live
+// neighbors comes alive, bit n of survive when a live one stays alive.
+// written as B.../S... rulestrings, B3/S23 for Life. -l
+struct rule {
+    uint16_t birth, survive;
+};
+
+#define LIFE_BIRTH 0x008   // B3
+#define LIFE_SURVIVE 0x00C // S23
+
+extern struct rule rule;
+
+int parse_rule(const char *text, struct rule *rule); // a rulestring or a name below, 0 if neither
+void format_rule(const struct rule *rule, char *text, size_t size);
+int rule_is(const struct rule *rule, unsigned birth, unsigned survive);
+
+// rules the bytes and bits engines have kernels compiled for, as
+// X(name, birth, survive). any other rule runs through the same kernels
+// with the masks read at run time.
+#define SPECIALIZED_RULES(X) \
+    X(life, 0x008, 0x00C)     /* B3/S23 */ \
+    X(highlife, 0x048, 0x00C) /* B36/S23 */ \
+    X(daynight, 0x1C8, 0x1D8) /* B3678/S34678 */ \
+    X(seeds, 0x004, 0x000)    /* B2/S */
+
+// what lies past the edges of a bounded grid: dead cells, or the opposite
+// edge so the grid wraps around into a torus. -w dead|torus
+enum boundary {
+    BOUNDARY_DEAD,
+    BOUNDARY_TORUS,
+};
+
+extern enum boundary boundary;
+extern const char *boundary_names[];
+
+void fill_halo(struct grid *grid); // the halo ring as the boundary has it
+
+// update_points() steps the grid the naive engine was loaded with in place.
+// it skips blocks of BLOCK_SIZE x BLOCK_SIZE cells that are settled, i.e.
+// neither they nor their neighbors changed last generation
+#define BLOCK_SIZE 8
+
+extern int blocks_skipped; // by the last update_points()
+extern uint64_t points_births, points_deaths; // by the last update_points()
+
+void update_points(struct grid *grid);
+void mark_all_points_changed(void);
+
+// CRC32 of the grid packed 8 cells to a byte, equal grids digest equal.
+// digest_rows() takes count packed rows of cols cells directly, column c at
+// bit c % 64 of word c / 64, stride words apart.
+void init_digest(void); // done by init_points()
+uint32_t grid_digest(const struct grid *grid);
+uint32_t digest_rows(const uint64_t *rows, size_t stride, int count, int cols);
+
+// the grid as rows of words laid out like digest_rows() wants them, words
+// apart. the bits past the last column are 0
+void pack_grid(const struct grid *grid, uint64_t *bits, int words);
+
+extern int log_digests; // print the digest of every generation, -c
+
+// starting patterns, see pattern.c. name is soup (random cells at the given
+// density), a built in pattern (blinker, glider, rpent, acorn, pulsar,
+// gosper) or an RLE file. the grid grows to fit a pattern bigger than it.
+// returns 0 if it couldn't be loaded.
+int load_pattern(struct grid *grid, const char *name, double density, uint64_t seed);
+int load_rle(struct grid *grid, const char *rle);
+void load_soup(struct grid *grid, double density, uint64_t seed);
+
+// the population after a step and the cells born and died in its last
+// generation. the engines tally births and deaths as their kernels write
+// each row and keep the population up to date from them, so none of it
+// costs a pass over the grid. hashlife only knows the population.
+struct life_stats {
+    uint64_t generation; // filled in by whoever records it
+    uint64_t population;
+    uint64_t births, deaths;
+    int counted; // births and deaths are known
+};
+
+// a simulation engine keeps its own copy of the cells and steps it
+struct engine {
+    const char *name;
+    int (*load)(struct grid *grid); // copy a grid into the engine, 0 if out of memory
+    uint64_t (*step)(void);         // advance, returns how many generations, 0 if out of memory (or out of universe) and nothing changed
+    void (*store)(struct grid *grid); // copy the engine's cells back into the grid it loaded
+    uint32_t (*digest)(void);       // grid_digest() without a store(), or NULL
+    void (*pack)(uint64_t *bits, int words); // pack_grid() without a store(), or NULL
+    void (*stats)(struct life_stats *stats); // of the last step(), or load() before any
+};
+
+extern const struct engine naive_engine; // update_points() on the grid itself, the reference
+extern const struct engine bytes_engine; // one byte per cell
+extern const struct engine bits_engine;  // 64 cells per uint64_t word
+extern const struct engine hashlife_engine; // memoized quadtree, unbounded
+extern const struct engine sparse_engine; // hash map of 64x64 tiles, unbounded
+extern const struct engine lut_engine;   // 4x4 -> 2x2 lookup table
+
+extern const struct engine *engines[];
+
+// HashLife steps 2^hashlife_step_log2 generations at a time and garbage
+// collects its node table once it grows past hashlife_memory_cap bytes
+extern int hashlife_step_log2;
+extern size_t hashlife_memory_cap;
+
+uint64_t hashlife_advance(int log2_generations);
+size_t hashlife_memory_used(void);
+
+int sparse_tile_count(void);
+
+// the bits engine steps bits_block_generations generations in one pass over
+// the grid, -f
+#define MAX_BLOCK_GENERATIONS 256
+
+extern int bits_block_generations;
+
+uint64_t bits_advance(int generations); // one block of that many
+
+// next generation of the center 2x2 of every 4x4 neighborhood. bit y * 4 + x
+// of the index is the cell at (x, y), bit (y - 1) * 2 + x - 1 of the entry
+// the center cell at (x, y). init_life_table() builds it for the rule, again
+// whenever the rule changed.
+extern unsigned char life_table[1 << 16];
+
+void init_life_table(void);
+
+const struct engine *find_engine(const char *name);
+
+uint32_t engine_digest(const struct engine *engine, struct grid *grid); // store()s if it has to
+void engine_pack(const struct engine *engine, struct grid *grid, uint64_t *bits, int words); // store()s if it has to
+int engine_bounded(const struct engine *engine); // the grid is its whole universe, it can wrap or run B0
+uint64_t engine_step_within(const struct engine *engine, uint64_t limit); // step() of at most limit generations
+// spotting a universe that has turned periodic from the digests of its
+// generations. a period counts once it held for a whole period, so it has
+// to fit into the history twice.
+//
+// digesting every generation costs more than a fast engine's step, so the
+// callers only feed it one every CYCLE_INTERVAL generations or so
+// (cycle_due()). generations seen that far apart only show a multiple of
+// the period, so after finding one it wants every generation until the grid
+// is back where it was, which is after the period itself. start can be late
+// by up to the interval.
+#define CYCLE_HISTORY 256
+#define CYCLE_INTERVAL 256
+
+struct cycle {
+    uint64_t generations[CYCLE_HISTORY];
+    uint32_t digests[CYCLE_HISTORY];
+    int count, next;           // ring of the latest digests
+    uint64_t candidate, since; // period being confirmed, first generation it held
+    uint64_t start, period;    // once found: first generation of the cycle, its length
+    uint64_t multiple, anchor; // a multiple of the period being narrowed down from generation anchor on
+    uint32_t anchor_digest;
+};
+
+extern int detect_cycles; // on unless -k
+
+void cycle_reset(struct cycle *cycle);
+int cycle_update(struct cycle *cycle, uint64_t generation, uint32_t digest); // 1 once periodic
+int cycle_due(const struct cycle *cycle, uint64_t generation); // wants the digest of this generation
+
+// one line of engine specific stats for the HUD
+void engine_status(const struct engine *engine, char *text, size_t size);
+
+// the bands of a step add what they counted into the step's, from any thread
+void stats_add(struct life_stats *stats, const struct life_stats *band);
+
+// births and deaths as the vector kernels count them, a lane per 64 bit
+// element of their registers. they're only added up once per band
+struct life_lanes {
+    uint64_t births[4], deaths[4];
+};
+
+static inline void lanes_add(struct life_stats *band, const struct life_lanes *lanes) {
+
+    for (int i = 0; i < 4; i++) {
+        band->births += lanes->births[i];
+        band->deaths += lanes->deaths[i];
+    }
+}
+
+// stats of the latest generations for the HUD chart and the headless log
+#define STATS_HISTORY 1024
+
+struct stats_history {
+    struct life_stats entries[STATS_HISTORY];
+    int count, next; // ring of the latest steps
+};
+
+extern int log_stats; // print the stats of every step when headless, -o
+
+void stats_reset(struct stats_history *history);
+void stats_record(struct stats_history *history, const struct life_stats *stats);
+const struct life_stats *stats_at(const struct stats_history *history, int age); // 0 is the newest, NULL past the oldest
+
+// a finished generation as handed from the simulation thread to the renderer
+struct frame {
+    uint64_t generation;
+    double rate;     // generations per second the simulation reached
+    char status[64]; // engine_status() of that generation
+    uint32_t digest; // digest of the cells
+    struct stats_history stats; // up to that generation
+    int rows, cols;
+    int words;       // per row of bits
+    uint64_t *bits;  // the cells as pack_grid() lays them out
+};
+
+static inline const uint64_t *frame_row(const struct frame *frame, int row) {
+    return frame->bits + (size_t)row * frame->words;
+}
+
+// blocks of 2^level x 2^level cells a frame is drawn in when zoomed out
+static inline int mip_rows(const struct frame *frame, int level) {
+    return (frame->rows + (1 << level) - 1) >> level;
+}
+
+static inline int mip_cols(const struct frame *frame, int level) {
+    return (frame->cols + (1 << level) - 1) >> level;
+}
+
+// simulation thread, see sim.c. sim_run(0) blocks until the thread is idle,
+// after that the grid and the engine belong to the caller again.
+int sim_start(const struct engine *engine, struct grid *grid);
+void sim_stop(void);
+void sim_run(int run);
+void sim_publish(void);  // snapshot the engine, or the grid while stopped, as the newest frame
+const struct frame *sim_latest(void); // newest frame, never blocks
+void sim_reset_generation(void);
+void sim_set_rate(double rate); // target generations per second, 0 for unlimited
+double sim_rate(void);
+int sim_failed(void); // the engine ran out of memory and the thread stopped, since the last call
+
+// persistent worker threads. workers_run() splits rows into one band per
+// thread and returns once every band is done.
+typedef void (*band_fn)(int begin, int end, void *data);
+
+int workers_start(int threads); // 0 starts one per logical core
+void workers_stop(void);
+int worker_count(void);
+void workers_run(band_fn band, void *data, int rows);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LIFE_INLINE static inline __attribute__((always_inline))
+#else
+#define LIFE_INLINE static inline
+#endif
+
+#define LIFE_ADD3(a, b, c, sum, carry) \
+    do { \
+        uint64_t t_ = (a) ^ (b); \
+        sum = t_ ^ (c); \
+        carry = ((a) & (b)) | (t_ & (c)); \
+    } while (0)
+
+static inline int life_popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// neighbor counts of the 64 cells in mid[w], with the words either side of
+// w in the rows above and below, for the bit-packed engines. full adders
+// over whole words: every bit position is its own cell, and bit i of
+// count[k] is bit k of the count of cell i.
+LIFE_INLINE void life_count(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int w, uint64_t count[4]) {
+
+    // neighbors lined up on the cell: bit i of *_w is column i - 1, of *_e column i + 1
+    uint64_t up_w = (up[w] << 1) | (up[w - 1] >> 63);
+    uint64_t up_e = (up[w] >> 1) | (up[w + 1] << 63);
+    uint64_t mid_w = (mid[w] << 1) | (mid[w - 1] >> 63);
+    uint64_t mid_e = (mid[w] >> 1) | (mid[w + 1] << 63);
+    uint64_t down_w = (down[w] << 1) | (down[w - 1] >> 63);
+    uint64_t down_e = (down[w] >> 1) | (down[w + 1] << 63);
+
+    // 2-bit counts of the row above, the row below and the two side cells
+    uint64_t up0, up1, down0, down1;
+    LIFE_ADD3(up_w, up[w], up_e, up0, up1);
+    LIFE_ADD3(down_w, down[w], down_e, down0, down1);
+    uint64_t mid0 = mid_w ^ mid_e;
+    uint64_t mid1 = mid_w & mid_e;
+
+    // add them up: count[0] is worth 1, count[1] 2, count[2] 4 and count[3] 8
+    uint64_t carry0, ones, carry1;
+    LIFE_ADD3(up0, down0, mid0, count[0], carry0);
+    LIFE_ADD3(up1, down1, mid1, ones, carry1);
+    count[1] = ones ^ carry0;
+    count[2] = carry1 ^ (ones & carry0);
+    count[3] = carry1 & ones & carry0;
+}
+
+// the cells of a word whose count is n and whose state the rule turns
+// alive: dead ones for birth, live ones for survive, with the masks widened
+// to whole words. with constant masks only the terms of the counts the rule
+// has are left after inlining.
+#define RULE_TERM(n, high, low, alive, birth, survive) \
+    ((high) & (low) & (((alive) & (0 - (uint64_t)((survive) >> (n) & 1))) | (~(alive) & (0 - (uint64_t)((birth) >> (n) & 1)))))
+
+LIFE_INLINE uint64_t rule_apply(const uint64_t count[4], uint64_t alive, unsigned birth, unsigned survive) {
+
+    // one term for each value of count[1..0] and of count[3..2], 8 is count[3] alone
+    uint64_t low0 = ~(count[1] | count[0]), low1 = ~count[1] & count[0];
+    uint64_t low2 = count[1] & ~count[0], low3 = count[1] & count[0];
+    uint64_t high0 = ~(count[3] | count[2]), high1 = count[2];
+
+    return RULE_TERM(0, high0, low0, alive, birth, survive) | RULE_TERM(1, high0, low1, alive, birth, survive)
+         | RULE_TERM(2, high0, low2, alive, birth, survive) | RULE_TERM(3, high0, low3, alive, birth, survive)
+         | RULE_TERM(4, high1, low0, alive, birth, survive) | RULE_TERM(5, high1, low1, alive, birth, survive)
+         | RULE_TERM(6, high1, low2, alive, birth, survive) | RULE_TERM(7, high1, low3, alive, birth, survive)
+         | RULE_TERM(8, count[3], ~0ULL, alive, birth, survive);
+}
+
+// next generation of the 64 cells in mid[w]
+LIFE_INLINE uint64_t rule_word(const uint64_t *up, const uint64_t *mid, const uint64_t *down, int w, unsigned birth, unsigned survive) {
+
+    uint64_t count[4];
+
+    life_count(up, mid, down, w, count);
+
+    return rule_apply(count, mid[w], birth, survive);
+}
+
+
+// instruction sets the vector kernels are built for, picked at startup.
+// every level produces exactly the same generations.
+enum simd_level {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+extern enum simd_level simd_level; // kernels used by the next load()
+
+extern const char *simd_names[];   // indexed by enum simd_level
+
+enum simd_level detect_simd(void); // best level this cpu supports
+
+#endif
@@ -0,0 +1,269 @@
+#include <stdint.h>
+#include <SDL3/SDL_stdinc.h>
+#include "life.h"
+
+// lookup table engine: life_table maps every 4x4 neighborhood to the next
+// generation of its center 2x2, so the grid is stepped two by two cells with
+// one table load and no neighbor counting at all. hashlife uses the same
+// table for its 4x4 base case.
+//
+// rows are packed 64 cells to a word, column c at bit c + 64 of the row so
+// there is a pad word to the left and pad words to the right to read the
+// 4x4 window from without any bounds checks, and pad rows above and below.
+// the pads are dead, or on a torus hold the opposite edge.
+
+unsigned char life_table[1 << 16];
+
+static int life_table_ready;
+static struct rule life_table_rule; // what it was built for
+
+static int lut_rows, lut_cols;
+static int lut_words; // per row, pads included
+
+static uint64_t *lut_cur;
+static uint64_t *lut_next;
+
+
+void init_life_table(void) {
+
+    if (life_table_ready && rule_is(&life_table_rule, rule.birth, rule.survive)) {
+        return;
+    }
+
+    for (int i = 0; i < 1 << 16; i++) {
+        unsigned char next = 0;
+
+        for (int y = 1; y <= 2; y++) {
+            for (int x = 1; x <= 2; x++) {
+                int sum = 0;
+
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        sum += (i >> ((y + dy) * 4 + x + dx)) & 1;
+                    }
+                }
+
+                int alive = (i >> (y * 4 + x)) & 1;
+                sum -= alive;
+
+                if (((alive ? rule.survive : rule.birth) >> sum) & 1) {
+                    next |= 1 << ((y - 1) * 2 + x - 1);
+                }
+            }
+        }
+
+        life_table[i] = next;
+    }
+
+    life_table_rule = rule;
+    life_table_ready = 1;
+}
+
+static uint64_t *lut_row(uint64_t *grid, int row) {
+    return grid + (size_t)(row + 1) * lut_words;
+}
+
+// both buffers for a grid of rows x cols, pads and all zero
+static int lut_resize(int rows, int cols) {
+
+    size_t size = (size_t)(rows + 3) * (cols / 64 + 4) * sizeof(uint64_t);
+
+    if (rows != lut_rows || cols != lut_cols) {
+        SDL_aligned_free(lut_cur);
+        SDL_aligned_free(lut_next);
+        lut_cur = SDL_aligned_alloc(CACHE_LINE, size);
+        lut_next = SDL_aligned_alloc(CACHE_LINE, size);
+
+        if (!lut_cur || !lut_next) {
+            lut_rows = lut_cols = 0;
+            return 0;
+        }
+
+        lut_rows = rows;
+        lut_cols = cols;
+        lut_words = cols / 64 + 4;
+    }
+
+    SDL_memset(lut_cur, 0, size);
+    SDL_memset(lut_next, 0, size);
+
+    return 1;
+}
+
+// copy the opposite edges into the pads, column -1 and column lut_cols
+static void lut_wrap(uint64_t *grid) {
+
+    int last = lut_cols - 1 + 64, after = lut_cols + 64;
+
+    for (int row = 0; row < lut_rows; row++) {
+        uint64_t *words = lut_row(grid, row);
+
+        words[0] = (words[last / 64] >> (last % 64) & 1) << 63;
+        words[after / 64] = (words[after / 64] & ~(1ULL << (after % 64))) | (words[1] & 1) << (after % 64);
+    }
+
+    SDL_memcpy(lut_row(grid, -1), lut_row(grid, lut_rows - 1), lut_words * sizeof(uint64_t));
+    SDL_memcpy(lut_row(grid, lut_rows), lut_row(grid, 0), lut_words * sizeof(uint64_t));
+}
+
+// the 4 cells from column col - 1 to col + 2
+static unsigned lut_nibble(const uint64_t *row, int col) {
+
+    int bit = col + 63;
+    int shift = bit % 64;
+    const uint64_t *w = row + bit / 64;
+
+    // two-word funnel shift, split so shift 0 doesn't shift by 64
+    return ((w[0] >> shift) | ((w[1] << 1) << (63 - shift))) & 0xF;
+}
+
+static struct life_stats lut_stats;
+
+// cells born and died between a row and the next generation of it, leaving
+// out the pad bits a torus puts into the old one
+static void lut_tally(const uint64_t *was, const uint64_t *now, struct life_stats *band) {
+
+    int after = lut_cols + 64;
+
+    for (int w = 1; w < lut_words; w++) {
+        uint64_t old = w == after / 64 ? was[w] & ~(1ULL << (after % 64)) : was[w];
+        uint64_t changed = old ^ now[w];
+
+        if (changed) {
+            band->births += life_popcount(changed & now[w]);
+            band->deaths += life_popcount(changed & old);
+        }
+    }
+}
+
+static void lut_band(int begin, int end, void *data) {
+
+    struct life_stats band = {0};
+
+    (void)data;
+
+    // band rows are pairs of grid rows
+    for (int pair = begin; pair < end; pair++) {
+        int row = pair * 2;
+        const uint64_t *r0 = lut_row(lut_cur, row - 1);
+        const uint64_t *r1 = lut_row(lut_cur, row);
+        const uint64_t *r2 = lut_row(lut_cur, row + 1);
+        const uint64_t *r3 = lut_row(lut_cur, row + 2);
+        uint64_t *top = lut_row(lut_next, row);
+        uint64_t *bottom = lut_row(lut_next, row + 1);
+
+        for (int w = 0; w < lut_words; w++) {
+            top[w] = 0;
+            bottom[w] = 0;
+        }
+
+        for (int col = 0; col < lut_cols; col += 2) {
+            unsigned index = lut_nibble(r0, col) | lut_nibble(r1, col) << 4
+                           | lut_nibble(r2, col) << 8 | lut_nibble(r3, col) << 12;
+            unsigned next = life_table[index];
+
+            int bit = col + 64;
+            top[bit / 64] |= (uint64_t)(next & 3) << (bit % 64);
+            bottom[bit / 64] |= (uint64_t)(next >> 2) << (bit % 64);
+        }
+
+        // an odd width computes one column too many, an odd height one row
+        if (lut_cols % 2) {
+            top[(lut_cols + 64) / 64] &= ~(1ULL << ((lut_cols + 64) % 64));
+            bottom[(lut_cols + 64) / 64] &= ~(1ULL << ((lut_cols + 64) % 64));
+        }
+
+        if (row + 1 >= lut_rows) {
+            for (int w = 0; w < lut_words; w++) {
+                bottom[w] = 0;
+            }
+        } else {
+            lut_tally(r2, bottom, &band);
+        }
+
+        lut_tally(r1, top, &band);
+    }
+
+    stats_add(&lut_stats, &band);
+}
+
+static uint64_t lut_step(void) {
+
+    // the dead pads are never written
+    if (boundary == BOUNDARY_TORUS) {
+        lut_wrap(lut_cur);
+    }
+
+    lut_stats.births = lut_stats.deaths = 0;
+
+    workers_run(lut_band, NULL, (lut_rows + 1) / 2);
+
+    uint64_t *tmp = lut_cur;
+    lut_cur = lut_next;
+    lut_next = tmp;
+
+    lut_stats.population += lut_stats.births - lut_stats.deaths;
+
+    return 1;
+}
+
+static int lut_load(struct grid *grid) {
+
+    if (!lut_resize(grid->rows, grid->cols)) {
+        return 0;
+    }
+
+    init_life_table();
+    lut_stats = (struct life_stats){.counted = 1};
+
+    for (int row = 0; row < lut_rows; row++) {
+        const uint8_t *cells = grid_row(grid, row);
+        uint64_t *words = lut_row(lut_cur, row);
+
+        for (int col = 0; col < lut_cols; col++) {
+            if (1 == cells[col]) {
+                words[(col + 64) / 64] |= 1ULL << ((col + 64) % 64);
+                lut_stats.population++;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static void lut_store(struct grid *grid) {
+
+    for (int row = 0; row < lut_rows; row++) {
+        const uint64_t *words = lut_row(lut_cur, row);
+        uint8_t *cells = grid_row(grid, row);
+
+        for (int col = 0; col < lut_cols; col++) {
+            cells[col] = (words[(col + 64) / 64] >> ((col + 64) % 64)) & 1;
+        }
+    }
+}
+
+// column 0 is bit 0 of the second word of a row
+static uint32_t lut_digest(void) {
+    return digest_rows(lut_row(lut_cur, 0) + 1, lut_words, lut_rows, lut_cols);
+}
+
+// column 0 is bit 0 of the second word of a row, the pad words past the
+// last column may not be dead
+static void lut_pack(uint64_t *bits, int words) {
+
+    int used = lut_cols - (words - 1) * 64;
+
+    for (int row = 0; row < lut_rows; row++) {
+        uint64_t *out = bits + (size_t)row * words;
+
+        SDL_memcpy(out, lut_row(lut_cur, row) + 1, words * sizeof(uint64_t));
+        out[words - 1] &= used == 64 ? ~0ULL : (1ULL << used) - 1;
+    }
+}
+
+static void lut_get_stats(struct life_stats *stats) {
+    *stats = lut_stats;
+}
+
+const struct engine lut_engine = {"lut", lut_load, lut_step, lut_store, lut_digest, lut_pack, lut_get_stats};
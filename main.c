@@ -1,8 +1,7 @@
 #include <stdio.h>
+#include <string.h>
 #include <SDL3/SDL.h>
-
-#define SCREEN_WIDTH 1200
-#define SCREEN_HEIGHT 800
+#include "life.h"
 
 #define RGBA(c) \
     ((c >> 24) & 0xFF), \
@@ -15,187 +14,1064 @@
 #define COLOR_GRAY 0xB0B0B0FF
 #define COLOR_BLACK 0x000000FF
 
-#define CELL_SIZE 18
-#define ROWS SCREEN_HEIGHT / CELL_SIZE
-#define COLS SCREEN_WIDTH / CELL_SIZE
 #define GRIDLINE_WIDTH 1
 
-#define GENERATION_SPEED 10 // once each x game loop iteration
+#define FRAME_DELAY 10 // ms between frames
+
+// generations per second, changed with + and - at runtime
+#define DEFAULT_SPEED 10
+#define MIN_SPEED (1.0 / 16)
+#define MAX_SPEED 1000000
+
+// below this many pixels per cell gridlines would cover most of every cell
+#define GRID_MIN_CELL 4
+
+// zoom limits in pixels per cell, and the zoom per mouse wheel notch
+#define MAX_CELL 128
+#define ZOOM_STEP 1.1f
 
-struct point {
-    int row, col;
-    int state; // 0 is dead, 1 is alive
+// population chart under the hud, one pixel per step
+#define CHART_WIDTH 256
+#define CHART_HEIGHT 48
+
+// the camera: which part of the grid is on screen and how big
+struct view {
+    float x, y;        // grid position, in cells, of the top left pixel
+    float cell;        // pixels per cell
+    int width, height; // render output size in pixels
 };
 
+static struct view view = {0, 0, CELL_SIZE, SCREEN_WIDTH, SCREEN_HEIGHT};
+
+// the cells, -x and -y or a pattern bigger than that pick the size
+static struct grid points;
+
+static int same_view(const struct view *a, const struct view *b) {
+    return a->x == b->x && a->y == b->y && a->cell == b->cell && a->width == b->width && a->height == b->height;
+}
+
+// whole grid on screen, in whole pixels per cell while there is room for that
+void fit_view(void) {
+
+    float cell = SDL_min((float)view.width / points.cols, (float)view.height / points.rows);
+
+    view.cell = cell >= 1 ? SDL_floorf(cell) : cell;
+    view.x = 0;
+    view.y = 0;
+}
+
+// zoom by factor keeping the cell under pixel (px, py) in place
+void zoom_view(float factor, float px, float py) {
+
+    float fit = SDL_min((float)view.width / points.cols, (float)view.height / points.rows);
+    float min_cell = SDL_min(fit / 4, 0.5f);
+
+    float gx = view.x + px / view.cell;
+    float gy = view.y + py / view.cell;
+
+    view.cell = SDL_clamp(view.cell * factor, min_cell, MAX_CELL);
+    view.x = gx - px / view.cell;
+    view.y = gy - py / view.cell;
+}
+
+void pan_view(float dx, float dy) {
+    view.x -= dx / view.cell;
+    view.y -= dy / view.cell;
+}
+
+// lines between the visible cells, spanning only the grid
+void draw_grid(SDL_Renderer *renderer) {
+
+    float left = SDL_max(0, -view.x * view.cell);
+    float top = SDL_max(0, -view.y * view.cell);
+    float right = SDL_min(view.width, (points.cols - view.x) * view.cell);
+    float bottom = SDL_min(view.height, (points.rows - view.y) * view.cell);
+
+    int first_row = SDL_max(0, (int)SDL_ceilf(view.y));
+    int last_row = SDL_min(points.rows, (int)SDL_floorf(view.y + view.height / view.cell));
+    int first_col = SDL_max(0, (int)SDL_ceilf(view.x));
+    int last_col = SDL_min(points.cols, (int)SDL_floorf(view.x + view.width / view.cell));
+
+    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_GRAY));
+
+    // rows
+    for (int row = first_row; row <= last_row; row++) {
+        SDL_FRect line = {left, SDL_floorf((row - view.y) * view.cell), right - left, GRIDLINE_WIDTH};
+        SDL_RenderFillRect(renderer, &line);
+    }
+
+    // for cols
+    for (int col = first_col; col <= last_col; col++) {
+        SDL_FRect line = {SDL_floorf((col - view.x) * view.cell), top, GRIDLINE_WIDTH, bottom - top};
+        SDL_RenderFillRect(renderer, &line);
+    }
+
+}
+
+
+void toggle_point(float x, float y, int btnIndex) {
+
+   
+    int cellRow = (int)SDL_floorf(view.y + y / view.cell);
+    int cellCol = (int)SDL_floorf(view.x + x / view.cell);
+
+    if (cellRow < 0 || cellRow >= points.rows || cellCol < 0 || cellCol >= points.cols) {
+        return;
+    }
+
+    int next_state;
+
+    if(1 == btnIndex) {
+        next_state = 1;
+    } else if ((3 == btnIndex) || (4 == btnIndex)) {
+        next_state = 0;
+    } else {
+        // the middle button pans
+        return;
+    }
+
+    // shows up with the next frame, see sim_publish()
+    set_point(&points, cellRow, cellCol, next_state);
+}
+
 
-struct point points[ROWS][COLS];
 
+// the cells under the window as one texel each, stretched view.cell times
+// over it. the grid can be far bigger than any texture, so it only holds
+// cells_rect of it
+static SDL_Texture *cells_texture;
+static SDL_Rect cells_rect;
+static int cells_valid; // cells_texture matches presented over cells_rect
 
-void init_points(){
+// one texel per block of 2^density_level cells square, for views below a
+// pixel per cell, shaded from a row of counts at a time in density_counts
+static SDL_Texture *density_texture;
+static int density_level;
+static SDL_Rect density_rect; // blocks of density_level it holds
+static uint32_t *density_counts; // as many as the texture is wide
 
-    // store points
-    for (int row = 0; row < ROWS; row++) {
-        for(int col = 0; col < COLS; col++) {
-            points[row][col].row = row;
-            points[row][col].col = col;
-            points[row][col]. state = 0;
+// population mipmaps from DENSITY_BASE up: density_mips[k] counts the live
+// cells of every 2^k x 2^k block, uint16_t up to 128 x 128 blocks and
+// uint32_t above. the levels below the base are counted straight from the
+// words under the window, which are at most 16 per pixel. the base follows
+// the frames a band of 2^DENSITY_BASE rows at a time, only where they
+// differ from density_source, and the levels above it are built the first
+// time they're drawn and then kept up to date over the rows that changed
+#define DENSITY_BASE 3
+#define DENSITY_LEVELS 32
+
+static void *density_mips[DENSITY_LEVELS];
+static int density_top;             // highest level up to date, below DENSITY_BASE for none
+static uint64_t *density_source;    // the cells the mips count, packed like frame->bits
+static uint32_t *density_scratch;   // a row of the base level
+static uint64_t density_generation; // and digest of the frame they were last brought up to
+static uint32_t density_digest;
+
+// gridlines as big as the window, blended over the cells every frame and
+// only redrawn when the view changes
+static SDL_Texture *grid_texture;
+static struct view grid_view;
+
+// the frame cells_texture was last updated from, packed like frame->bits
+static uint64_t *presented;
+
+void draw_grid_texture(SDL_Renderer *renderer) {
+
+    SDL_SetRenderTarget(renderer, grid_texture);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    if (view.cell >= GRID_MIN_CELL) {
+        draw_grid(renderer);
+    }
+
+    SDL_SetRenderTarget(renderer, NULL);
+
+    grid_view = view;
+}
+
+// redraw the gridlines if the view moved since they were drawn
+int update_grid_texture(SDL_Renderer *renderer) {
+
+    if (grid_texture && same_view(&view, &grid_view)) {
+        return 1;
+    }
+
+    if (!grid_texture || view.width != grid_view.width || view.height != grid_view.height) {
+        SDL_DestroyTexture(grid_texture);
+        grid_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, view.width, view.height);
+
+        if (!grid_texture) {
+            return 0;
         }
 
+        SDL_SetTextureBlendMode(grid_texture, SDL_BLENDMODE_BLEND);
     }
+
+    draw_grid_texture(renderer);
+
+    return 1;
 }
 
+// track the render output size. returns 1 when it changed and the window
+// needs repainting.
+int update_view(SDL_Renderer *renderer) {
 
-// update points
-void update_points() {
-    int next_state[ROWS][COLS];
+    int width, height;
 
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            int total_alive_neighbors = 0;
+    if (!SDL_GetCurrentRenderOutputSize(renderer, &width, &height) || width <= 0 || height <= 0) {
+        return 0;
+    }
 
-            // for neighbors
-            for (int x = -1; x <= 1; x++) {
-                for (int y = -1; y <= 1; y++) {
-                    if (x == 0 && y == 0) continue; // skip itself
+    if (width == view.width && height == view.height) {
+        return 0;
+    }
 
-                    int neigh_r = row + x;
-                    int neigh_c = col + y;
+    view.width = width;
+    view.height = height;
 
-                    if (neigh_r >= 0 && neigh_r < ROWS && neigh_c >= 0 && neigh_c < COLS) {
-                        if (points[neigh_r][neigh_c].state == 1) {
-                            total_alive_neighbors++;
-                        }
-                    }
+    return 1;
+}
+
+// room for the most cells the window shows from a pixel per cell up
+int update_cells_size(SDL_Renderer *renderer) {
+
+    int cols = SDL_min(points.cols, view.width + 2);
+    int rows = SDL_min(points.rows, view.height + 2);
+    float width, height;
+
+    if (cells_texture && SDL_GetTextureSize(cells_texture, &width, &height) && (int)width == cols && (int)height == rows) {
+        return 1;
+    }
+
+    SDL_DestroyTexture(cells_texture);
+    cells_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, cols, rows);
+    cells_valid = 0;
+
+    if (!cells_texture) {
+        return 0;
+    }
+
+    SDL_SetTextureScaleMode(cells_texture, SDL_SCALEMODE_NEAREST);
+
+    return 1;
+}
+
+int init_textures(SDL_Renderer *renderer) {
+
+    presented = SDL_calloc((size_t)points.rows * ((points.cols + 63) / 64), sizeof(uint64_t));
+
+    if (!presented) {
+        return 0;
+    }
+
+    update_view(renderer);
+
+    return update_cells_size(renderer) && update_grid_texture(renderer);
+}
+
+void free_textures(void) {
+
+    SDL_DestroyTexture(cells_texture);
+    SDL_DestroyTexture(density_texture);
+    SDL_DestroyTexture(grid_texture);
+    cells_texture = NULL;
+    density_texture = NULL;
+    grid_texture = NULL;
+    cells_valid = 0;
+
+    SDL_free(presented);
+    SDL_free(density_counts);
+    presented = NULL;
+    density_counts = NULL;
+
+    for (int level = 0; level < DENSITY_LEVELS; level++) {
+        SDL_free(density_mips[level]);
+        density_mips[level] = NULL;
+    }
+
+    SDL_free(density_source);
+    SDL_free(density_scratch);
+    density_source = NULL;
+    density_scratch = NULL;
+    density_top = 0;
+}
+
+// the whole cells from the one at the top left pixel, up to as many as
+// cells_texture has room for
+static SDL_Rect visible_cells(void) {
+
+    float width, height;
+    SDL_Rect rect;
+
+    SDL_GetTextureSize(cells_texture, &width, &height);
+
+    rect.x = SDL_clamp((int)SDL_floorf(view.x), 0, points.cols - 1);
+    rect.y = SDL_clamp((int)SDL_floorf(view.y), 0, points.rows - 1);
+    rect.w = SDL_min((int)width, points.cols - rect.x);
+    rect.h = SDL_min((int)height, points.rows - rect.y);
+
+    return rect;
+}
+
+// copy the visible cells that flipped since the last frame into
+// cells_texture, in one locked rect per band of BLOCK_SIZE rows spanning its
+// changed columns. everything visible when the view moved. returns the
+// number of cells copied.
+int update_cells_texture(const struct frame *frame) {
+
+    SDL_Rect rect = visible_cells();
+
+    if (!SDL_RectsEqual(&rect, &cells_rect)) {
+        cells_rect = rect;
+        cells_valid = 0;
+    }
+
+    int first_word = rect.x / 64;
+    size_t span = ((rect.x + rect.w - 1) / 64 - first_word + 1) * sizeof(uint64_t);
+    int flipped = 0;
+
+    for (int top = rect.y; top < rect.y + rect.h; top += BLOCK_SIZE) {
+        int bottom = SDL_min(top + BLOCK_SIZE, rect.y + rect.h);
+        int left = rect.x + rect.w, right = -1;
+
+        for (int row = top; row < bottom; row++) {
+            const uint64_t *now = frame_row(frame, row);
+            const uint64_t *was = presented + (size_t)row * frame->words;
+
+            if (cells_valid && SDL_memcmp(was + first_word, now + first_word, span) == 0) {
+                continue;
+            }
+
+            for (int col = rect.x; col < rect.x + rect.w; col++) {
+                if (!cells_valid || (((now[col / 64] ^ was[col / 64]) >> (col % 64)) & 1)) {
+                    left = SDL_min(left, col);
+                    right = SDL_max(right, col);
+                    flipped++;
                 }
             }
+        }
 
-            // rules
-            if (points[row][col].state == 1) { // if already alive
-                if (total_alive_neighbors  == 2 || total_alive_neighbors == 3)
-                    next_state[row][col] = 1;
-                else
-                    next_state[row][col] = 0;
-            } else {
-                if (total_alive_neighbors == 3)
-                    next_state[row][col] = 1; // rule of birth
-                else
-                    next_state[row][col] = 0; // stays dead
+        if (right < 0) {
+            continue;
+        }
+
+        // locked texels are write only, so the whole rect is rewritten
+        SDL_Rect dirty = {left - rect.x, top - rect.y, right - left + 1, bottom - top};
+        void *pixels;
+        int pitch;
+
+        if (!SDL_LockTexture(cells_texture, &dirty, &pixels, &pitch)) {
+            continue;
+        }
+
+        for (int row = top; row < bottom; row++) {
+            Uint32 *texels = (Uint32 *)((Uint8 *)pixels + (row - top) * pitch);
+            const uint64_t *now = frame_row(frame, row);
+
+            for (int col = left; col <= right; col++) {
+                texels[col - left] = ((now[col / 64] >> (col % 64)) & 1) ? COLOR_BLACK : COLOR_WHITE;
+            }
+
+            SDL_memcpy(presented + (size_t)row * frame->words + first_word, now + first_word, span);
+        }
+
+        SDL_UnlockTexture(cells_texture);
+    }
+
+    cells_valid = 1;
+
+    return flipped;
+}
+
+// the visible cells and the gridlines in two draw calls, however many cells
+// are alive
+void draw_points(SDL_Renderer *renderer) {
+
+    SDL_FRect src = {0, 0, cells_rect.w, cells_rect.h};
+    SDL_FRect dst = {(cells_rect.x - view.x) * view.cell, (cells_rect.y - view.y) * view.cell,
+                     cells_rect.w * view.cell, cells_rect.h * view.cell};
+
+    SDL_RenderTexture(renderer, cells_texture, &src, &dst);
+    SDL_RenderTexture(renderer, grid_texture, NULL, NULL);
+}
+
+// the live cells of every size bit field of a word, side by side: the
+// steps of life_popcount()'s adder tree up to that width
+static uint64_t count_fields(uint64_t x, int size) {
+
+    x = x - (x >> 1 & 0x5555555555555555ULL);
+
+    if (size > 2) x = (x & 0x3333333333333333ULL) + (x >> 2 & 0x3333333333333333ULL);
+    if (size > 4) x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    if (size > 8) x = (x + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+    if (size > 16) x = (x + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+
+    return x;
+}
+
+// live cells of count blocks of a row of them from block first on, counted
+// a word at a time. blocks narrower than a word are all counted at once by
+// count_fields(), the even and the odd ones apart in fields twice as wide
+// so the sums of every row of the block fit. wider ones a popcount per word
+static void count_blocks(const struct frame *frame, int level, int block_row, int first, int count, uint32_t *counts) {
+
+    int size = 1 << level;
+    int top = block_row * size, bottom = SDL_min(top + size, frame->rows);
+
+    if (size < 64) {
+        uint64_t mask = size == 32 ? ~0ULL : (1ULL << 2 * size) - 1, even = 0;
+
+        for (int shift = 0; shift < 64; shift += 2 * size) {
+            even |= ((1ULL << size) - 1) << shift;
+        }
+
+        for (int c = first; c < first + count;) {
+            int w = c * size / 64;
+            uint64_t evens = 0, odds = 0;
+
+            for (int row = top; row < bottom; row++) {
+                uint64_t fields = count_fields(frame_row(frame, row)[w], size);
+
+                evens += fields & even;
+                odds += fields >> size & even;
+            }
+
+            for (; c < first + count && c * size / 64 == w; c++) {
+                int shift = c * size % 64;
+
+                counts[c - first] = (c % 2 ? odds >> (shift - size) : evens >> shift) & mask;
             }
         }
+
+        return;
     }
 
-    // Copy back to original grid
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            points[row][col].state = next_state[row][col];
+    int per_block = size / 64;
+
+    SDL_memset(counts, 0, count * sizeof(*counts));
+
+    for (int row = top; row < bottom; row++) {
+        const uint64_t *words = frame_row(frame, row);
+
+        for (int c = 0; c < count; c++) {
+            int w = (first + c) * per_block, end = SDL_min(w + per_block, frame->words);
+
+            for (; w < end; w++) {
+                counts[c] += life_popcount(words[w]);
+            }
         }
     }
 }
 
+static uint32_t density_count(int level, size_t index) {
+    return level < 8 ? ((const uint16_t *)density_mips[level])[index] : ((const uint32_t *)density_mips[level])[index];
+}
+
+// block row r of a level, from the words at the base and from the level
+// below above it
+static void density_row(const struct frame *frame, int level, int r) {
+
+    int cols = mip_cols(frame, level);
+
+    if (level == DENSITY_BASE) {
+        count_blocks(frame, level, r, 0, cols, density_scratch);
+    } else {
+        int below_rows = mip_rows(frame, level - 1), below_cols = mip_cols(frame, level - 1);
+
+        for (int c = 0; c < cols; c++) {
+            uint32_t sum = 0;
 
-void reset_all_points() {
+            for (int y = 2 * r; y < SDL_min(2 * r + 2, below_rows); y++) {
+                for (int x = 2 * c; x < SDL_min(2 * c + 2, below_cols); x++) {
+                    sum += density_count(level - 1, (size_t)y * below_cols + x);
+                }
+            }
 
-    for (int row = 0; row < ROWS; row++) {
-        for(int col = 0; col < COLS; col++) {
-            points[row][col].state = 0;
+            density_scratch[c] = sum;
+        }
+    }
+
+    size_t first = (size_t)r * cols;
+
+    for (int c = 0; c < cols; c++) {
+        if (level < 8) {
+            ((uint16_t *)density_mips[level])[first + c] = (uint16_t)density_scratch[c];
+        } else {
+            ((uint32_t *)density_mips[level])[first + c] = density_scratch[c];
         }
     }
 }
 
-void draw_grid(SDL_Renderer *renderer) {
+// the mips counting the frame's cells up to level, 0 if out of memory
+static int update_density(const struct frame *frame, int level) {
 
-    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_GRAY));
+    size_t source_size = (size_t)frame->rows * frame->words * sizeof(uint64_t);
 
-    // rows
-    for (int i = 0; i < SCREEN_HEIGHT; i += CELL_SIZE) {
-        SDL_FRect line = {0, i, SCREEN_WIDTH, GRIDLINE_WIDTH};
-        SDL_RenderFillRect(renderer, &line);
+    if (!density_source) {
+        density_source = SDL_malloc(source_size);
     }
 
-    // for cols
-    for (int i = 0; i < SCREEN_WIDTH; i += CELL_SIZE) {
-        SDL_FRect line = {i, 0, GRIDLINE_WIDTH, SCREEN_WIDTH};
-        SDL_RenderFillRect(renderer, &line);
+    if (!density_scratch) {
+        density_scratch = SDL_malloc(mip_cols(frame, DENSITY_BASE) * sizeof(*density_scratch));
+    }
+
+    if (!density_source || !density_scratch) {
+        return 0;
+    }
+
+    int rows = mip_rows(frame, DENSITY_BASE);
+    int band = 1 << DENSITY_BASE;
+    size_t band_size = (size_t)band * frame->words * sizeof(uint64_t);
+
+    // the base from scratch, or where the cells changed since
+    if (density_top < DENSITY_BASE) {
+        density_mips[DENSITY_BASE] = SDL_malloc((size_t)rows * mip_cols(frame, DENSITY_BASE) * sizeof(uint16_t));
+
+        if (!density_mips[DENSITY_BASE]) {
+            return 0;
+        }
+
+        SDL_memcpy(density_source, frame->bits, source_size);
+
+        for (int r = 0; r < rows; r++) {
+            density_row(frame, DENSITY_BASE, r);
+        }
+
+        density_top = DENSITY_BASE;
+    } else if (frame->generation != density_generation || frame->digest != density_digest) {
+        int first = rows, last = -1;
+
+        for (int r = 0; r < rows; r++) {
+            size_t offset = (size_t)r * band * frame->words;
+            size_t size = r == rows - 1 ? source_size - offset * sizeof(uint64_t) : band_size;
+
+            if (SDL_memcmp(density_source + offset, frame->bits + offset, size) != 0) {
+                SDL_memcpy(density_source + offset, frame->bits + offset, size);
+                density_row(frame, DENSITY_BASE, r);
+                first = SDL_min(first, r);
+                last = r;
+            }
+        }
+
+        for (int up = DENSITY_BASE + 1; up <= density_top && last >= 0; up++) {
+            first /= 2;
+            last /= 2;
+
+            for (int r = first; r <= last; r++) {
+                density_row(frame, up, r);
+            }
+        }
     }
 
+    density_generation = frame->generation;
+    density_digest = frame->digest;
+
+    // the levels above drawn for the first time
+    while (density_top < level) {
+        int up = density_top + 1;
+
+        density_mips[up] = SDL_malloc((size_t)mip_rows(frame, up) * mip_cols(frame, up) * (up < 8 ? sizeof(uint16_t) : sizeof(uint32_t)));
+
+        if (!density_mips[up]) {
+            return 0;
+        }
+
+        for (int r = 0; r < mip_rows(frame, up); r++) {
+            density_row(frame, up, r);
+        }
+
+        density_top = up;
+    }
+
+    return 1;
 }
 
+// zoomed out below a pixel per cell: blocks at least a pixel wide, shaded
+// by how many of their cells are alive. visits blocks, and cells only below
+// DENSITY_BASE, and only the ones under the window.
+void draw_density(SDL_Renderer *renderer, const struct frame *frame, int upload) {
 
-void toggle_point(SDL_Renderer *renderer, float x, float y, int btnIndex) {
+    int level = 1;
 
-   
-    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
-        return;
+    while (view.cell * (1 << level) < 1 && (mip_rows(frame, level) > 1 || mip_cols(frame, level) > 1)) {
+        level++;
     }
 
-    int cellRow = y / CELL_SIZE;
-    int cellCol = x / CELL_SIZE;
+    int rows = mip_rows(frame, level), cols = mip_cols(frame, level);
+    int width = SDL_min(cols, view.width + 2), height = SDL_min(rows, view.height + 2);
+    float texture_width, texture_height;
+
+    if (!density_texture || level != density_level || !SDL_GetTextureSize(density_texture, &texture_width, &texture_height)
+        || (int)texture_width != width || (int)texture_height != height) {
+        SDL_DestroyTexture(density_texture);
+        SDL_free(density_counts);
+        density_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        density_counts = SDL_malloc(width * sizeof(*density_counts));
+
+        if (!density_texture || !density_counts) {
+            SDL_DestroyTexture(density_texture);
+            density_texture = NULL;
+            return;
+        }
 
-    if (cellRow < 0 || cellRow >= ROWS || cellCol < 0 || cellCol >= COLS) {
-        return;
+        SDL_SetTextureScaleMode(density_texture, SDL_SCALEMODE_NEAREST);
+        density_level = level;
+        upload = 1;
     }
 
-    int next_state;
+    // the blocks from the one at the top left pixel
+    SDL_Rect rect;
+    rect.x = SDL_clamp((int)SDL_floorf(view.x / (1 << level)), 0, cols - 1);
+    rect.y = SDL_clamp((int)SDL_floorf(view.y / (1 << level)), 0, rows - 1);
+    rect.w = SDL_min(width, cols - rect.x);
+    rect.h = SDL_min(height, rows - rect.y);
 
-    if(1 == btnIndex) {
-        next_state = 1;
-    } else if ((3 == btnIndex) || (4 == btnIndex)) {
-        next_state = 0;
+    upload |= !SDL_RectsEqual(&rect, &density_rect);
+    density_rect = rect;
+
+    void *pixels;
+    int pitch;
+    SDL_Rect texels_rect = {0, 0, rect.w, rect.h};
+
+    // without the mips the blocks are counted from the words as well
+    int mipped = level >= DENSITY_BASE && upload && update_density(frame, level);
+
+    if (upload && SDL_LockTexture(density_texture, &texels_rect, &pixels, &pitch)) {
+        float scale = 255.0f / (1 << level) / (1 << level);
+
+        for (int r = 0; r < rect.h; r++) {
+            Uint32 *texels = (Uint32 *)((Uint8 *)pixels + r * pitch);
+
+            if (mipped) {
+                for (int c = 0; c < rect.w; c++) {
+                    density_counts[c] = density_count(level, (size_t)(rect.y + r) * cols + rect.x + c);
+                }
+            } else {
+                count_blocks(frame, level, rect.y + r, rect.x, rect.w, density_counts);
+            }
+
+            for (int c = 0; c < rect.w; c++) {
+                Uint32 v = 255 - (Uint32)(density_counts[c] * scale);
+                texels[c] = v << 24 | v << 16 | v << 8 | 0xFF;
+            }
+        }
+
+        SDL_UnlockTexture(density_texture);
     }
 
-    // draw
-    SDL_FRect point = {(cellCol * CELL_SIZE + GRIDLINE_WIDTH), (cellRow * CELL_SIZE+ 1), CELL_SIZE - GRIDLINE_WIDTH, CELL_SIZE - GRIDLINE_WIDTH};
+    float block = view.cell * (1 << level);
+    SDL_FRect src = {0, 0, rect.w, rect.h};
+    SDL_FRect dst = {(rect.x * (1 << level) - view.x) * view.cell, (rect.y * (1 << level) - view.y) * view.cell,
+                     rect.w * block, rect.h * block};
 
-    if (1 == next_state) {
-        SDL_SetRenderDrawColor(renderer, RGBA(COLOR_BLACK));
+    SDL_RenderTexture(renderer, density_texture, &src, &dst);
+}
+
+// generation count and engine stats
+void hud_text(const struct frame *frame, char *text, size_t size) {
+
+    char target[32];
+
+    double rate = sim_rate();
+
+    if (rate > 0) {
+        SDL_snprintf(target, sizeof(target), "%g", rate);
     } else {
-        SDL_SetRenderDrawColor(renderer, RGBA(COLOR_WHITE));  
+        SDL_snprintf(target, sizeof(target), "max");
     }
 
-    SDL_RenderFillRect(renderer, &point);
+    char changes[48] = "";
+    const struct life_stats *stats = stats_at(&frame->stats, 0);
+
+    if (stats && stats->counted) {
+        SDL_snprintf(changes, sizeof(changes), " +%" SDL_PRIu64 " -%" SDL_PRIu64, stats->births, stats->deaths);
+    }
 
-    points[cellRow][cellCol].state = next_state;
+    SDL_snprintf(text, size, "gen %" SDL_PRIu64 "  %.1f/%s gen/s  crc %08" SDL_PRIx32 "  pop %" SDL_PRIu64 "%s  %s",
+                 frame->generation, frame->rate, target, frame->digest, stats ? stats->population : 0, changes,
+                 frame->status);
 }
 
+// hud text in the top left corner
+void draw_hud(SDL_Renderer *renderer, const char *text) {
 
+    // 8x8 debug font on a white backing so it stays readable over cells
+    SDL_FRect backing = {0, 0, SDL_strlen(text) * 8 + 8, 16};
+
+    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_WHITE));
+    SDL_RenderFillRect(renderer, &backing);
 
-void draw_points(SDL_Renderer *renderer) {
-    
     SDL_SetRenderDrawColor(renderer, RGBA(COLOR_BLACK));
+    SDL_RenderDebugText(renderer, 4, 4, text);
+}
 
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col <COLS; col++){
-            if(1 == points[row][col].state) {
-                SDL_FRect point = {(col * CELL_SIZE + GRIDLINE_WIDTH), (row * CELL_SIZE+ 1), CELL_SIZE - GRIDLINE_WIDTH, CELL_SIZE - GRIDLINE_WIDTH};
+// population of the latest steps under the hud, newest on the right,
+// scaled from the fewest to the most of them
+void draw_chart(SDL_Renderer *renderer, const struct frame *frame) {
 
-                SDL_RenderFillRect(renderer, &point);
+    int count = SDL_min(frame->stats.count, CHART_WIDTH);
 
-            }
-        }
+    if (count < 2) {
+        return;
     }
 
+    uint64_t low = UINT64_MAX, high = 0;
+
+    for (int age = 0; age < count; age++) {
+        uint64_t population = stats_at(&frame->stats, age)->population;
+        low = SDL_min(low, population);
+        high = SDL_max(high, population);
+    }
+
+    SDL_FPoint line[CHART_WIDTH];
+    float range = high > low ? (float)(high - low) : 1;
+
+    for (int age = 0; age < count; age++) {
+        uint64_t population = stats_at(&frame->stats, age)->population;
+        line[count - 1 - age].x = 4 + CHART_WIDTH - age;
+        line[count - 1 - age].y = 20 + CHART_HEIGHT - (population - low) / range * CHART_HEIGHT;
+    }
+
+    SDL_FRect backing = {0, 16, CHART_WIDTH + 8, CHART_HEIGHT + 8};
+
+    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_WHITE));
+    SDL_RenderFillRect(renderer, &backing);
+
+    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_BLACK));
+    SDL_RenderLines(renderer, line, count);
 }
 
-void handleMouseClick(SDL_Renderer *renderer, SDL_MouseButtonEvent *button) {
+void handleMouseClick(SDL_MouseButtonEvent *button) {
 
     int btnIndex = button->button;
     float mouseX = button->x;
     float mouseY = button->y;
 
     if(btnIndex) {
-        toggle_point(renderer, mouseX, mouseY, btnIndex);
+        toggle_point(mouseX, mouseY, btnIndex);
     }
 
 }
 
 
-int main() {
+// -o: one line for every step
+void print_stats(const struct life_stats *stats) {
+
+    printf("generation %" SDL_PRIu64 " population %" SDL_PRIu64, stats->generation, stats->population);
+
+    if (stats->counted) {
+        printf(" births %" SDL_PRIu64 " deaths %" SDL_PRIu64, stats->births, stats->deaths);
+    }
+
+    printf("\n");
+}
+
+// -b: no window and no video at all, run the generations as fast as the
+// engine goes and report where they ended up
+int run_headless(const struct engine *engine, const char *pattern, uint64_t generations) {
+
+    char rule_text[32];
+    format_rule(&rule, rule_text, sizeof(rule_text));
+
+    printf("    Engine      : %s\n", engine->name);
+    printf("    Kernels     : %s\n", simd_names[simd_level]);
+    printf("    Threads     : %d\n", worker_count());
+    printf("    Pattern     : %s\n", pattern ? pattern : "empty");
+    printf("    Grid        : %d x %d, %s boundary\n", points.cols, points.rows, boundary_names[boundary]);
+    printf("    Rule        : %s\n", rule_text);
+
+    if (engine == &bits_engine && bits_block_generations > 1) {
+        printf("    Blocks      : %d generations\n", bits_block_generations);
+    }
+
+    if (!engine->load(&points)) {
+        printf("Couldn't allocate the engine's grid!\n");
+        return 1;
+    }
+
+    // a periodic universe isn't stepped any further than its first period
+    static struct cycle cycle;
+    int watch = detect_cycles && engine_bounded(engine);
+
+    cycle_reset(&cycle);
+
+    static struct stats_history history;
+    struct life_stats stats;
+
+    stats_reset(&history);
+    engine->stats(&stats);
+    stats_record(&history, &stats);
+
+    if (watch) {
+        cycle_update(&cycle, 0, engine_digest(engine, &points));
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    uint64_t generation = 0;
+    uint64_t stepped = 0;
+
+    while (generation < generations) {
+        // single generations while the detector narrows a period down
+        uint64_t step = engine_step_within(engine, cycle.multiple ? 1 : generations - generation);
+
+        if (!step) {
+            printf("The engine ran out of memory at generation %" SDL_PRIu64 "!\n", generation);
+            return 1;
+        }
+
+        generation += step;
+        stepped += step;
+
+        engine->stats(&stats);
+        stats.generation = generation;
+        stats_record(&history, &stats);
+
+        if (log_stats) {
+            print_stats(&stats);
+        }
+
+        int due = watch && cycle_due(&cycle, generation);
+
+        if (!log_digests && !due) {
+            continue;
+        }
+
+        uint32_t digest = engine_digest(engine, &points);
+
+        if (log_digests) {
+            printf("generation %" SDL_PRIu64 " digest %08" SDL_PRIx32 "\n", generation, digest);
+        }
+
+        if (due && cycle_update(&cycle, generation, digest)) {
+            // whole periods end where they started
+            generation += (generations - generation) / cycle.period * cycle.period;
+            watch = 0;
+        }
+    }
+
+    Uint64 end = SDL_GetPerformanceCounter();
+
+    engine->store(&points);
+
+    double seconds = (double)(end - start) / SDL_GetPerformanceFrequency();
+
+    printf("    Generations : %" SDL_PRIu64 "\n", generation);
+
+    if (cycle.period) {
+        printf("    Stabilized  : by generation %" SDL_PRIu64 " with period %" SDL_PRIu64 "\n", cycle.start, cycle.period);
+    }
+
+    // the whole universe for the unbounded engines, not only the grid
+    const struct life_stats *last = stats_at(&history, 0);
+
+    printf("    Population  : %" SDL_PRIu64 "\n", last->population);
+
+    if (last->counted) {
+        printf("    Changes     : +%" SDL_PRIu64 " -%" SDL_PRIu64 " in the last generation\n", last->births, last->deaths);
+    }
+    printf("    Digest      : %08" SDL_PRIx32 "\n", grid_digest(&points));
+    printf("    Time        : %.3f ms, %.3f us/generation\n", seconds * 1e3, stepped ? seconds * 1e6 / stepped : 0.0);
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+    // simulation engine, picked with -e <name>
+    const struct engine *engine = &naive_engine;
+
+    // vector kernels, the best the cpu has unless capped with -s <level>
+    simd_level = detect_simd();
+
+    // threads stepping the grid, -t <count>, 0 for one per logical core
+    int threads = 1;
+
+    // target generations per second, -g <rate>, 0 for as fast as possible
+    double speed = DEFAULT_SPEED;
+    int unlimited = 0;
+
+    // starting pattern, -p <name or RLE file>, soup density and seed with -d and -r
+    const char *pattern = NULL;
+    double density = 0.5;
+    uint64_t seed = 1;
+
+    // grid size in cells, -x <cols> and -y <rows>
+    int cols = DEFAULT_COLS;
+    int rows = DEFAULT_ROWS;
+
+    // -b <generations> runs headless
+    int headless = 0;
+    uint64_t generations = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            engine = find_engine(argv[++i]);
+
+            if (!engine) {
+                printf("Unknown engine '%s', available:", argv[i]);
+                for (int e = 0; engines[e]; e++) {
+                    printf(" %s", engines[e]->name);
+                }
+                printf("\n");
+                return 1;
+            }
+        }
+
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            i++;
+
+            int level = SIMD_SCALAR;
+            while (level <= SIMD_AVX2 && strcmp(simd_names[level], argv[i]) != 0) {
+                level++;
+            }
+
+            if (level > SIMD_AVX2) {
+                printf("Unknown kernel level '%s', use scalar, sse2 or avx2\n", argv[i]);
+                return 1;
+            }
+
+            if (level < (int)simd_level) {
+                simd_level = level;
+            }
+        }
+
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threads = SDL_atoi(argv[++i]);
+        }
+
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            speed = SDL_atof(argv[++i]);
+            unlimited = speed <= 0;
+            speed = unlimited ? DEFAULT_SPEED : SDL_clamp(speed, MIN_SPEED, MAX_SPEED);
+        }
+
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            pattern = argv[++i];
+        }
+
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            density = SDL_atof(argv[++i]);
+            density = SDL_clamp(density, 0, 1);
+        }
+
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            seed = SDL_strtoull(argv[++i], NULL, 10);
+        }
+
+        if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+            cols = SDL_atoi(argv[++i]);
+        }
+
+        if (strcmp(argv[i], "-y") == 0 && i + 1 < argc) {
+            rows = SDL_atoi(argv[++i]);
+        }
+
+        // Life-like rule, a B.../S... rulestring or a name like highlife
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            if (!parse_rule(argv[++i], &rule)) {
+                printf("Unknown rule '%s', use B.../S... like B36/S23\n", argv[i]);
+                return 1;
+            }
+        }
+
+        // dead cells past the edges, or a torus
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            i++;
+
+            int mode = BOUNDARY_DEAD;
+            while (mode <= BOUNDARY_TORUS && strcmp(boundary_names[mode], argv[i]) != 0) {
+                mode++;
+            }
+
+            if (mode > BOUNDARY_TORUS) {
+                printf("Unknown boundary '%s', use dead or torus\n", argv[i]);
+                return 1;
+            }
+
+            boundary = mode;
+        }
+
+        if (strcmp(argv[i], "-c") == 0) {
+            log_digests = 1;
+        }
+
+        if (strcmp(argv[i], "-o") == 0) {
+            log_stats = 1;
+        }
+
+        // keep stepping periodic universes instead of replaying them
+        if (strcmp(argv[i], "-k") == 0) {
+            detect_cycles = 0;
+        }
+
+        if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            headless = 1;
+            generations = SDL_strtoull(argv[++i], NULL, 10);
+        }
+
+        // hashlife: generations per step as a power of two, memory cap in MiB
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            int step_log2 = SDL_atoi(argv[++i]);
+            hashlife_step_log2 = SDL_clamp(step_log2, 0, 48);
+        }
+
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            int mib = SDL_atoi(argv[++i]);
+            hashlife_memory_cap = (size_t)SDL_max(mib, 1) << 20;
+        }
+
+        // bits: generations stepped per pass over the grid
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            int block = SDL_atoi(argv[++i]);
+            bits_block_generations = SDL_clamp(block, 1, MAX_BLOCK_GENERATIONS);
+        }
+    }
+
+    // an unbounded universe has no edges to wrap
+    if (boundary == BOUNDARY_TORUS && !engine_bounded(engine)) {
+        printf("The %s engine is unbounded, it can't wrap around into a torus\n", engine->name);
+        return 1;
+    }
+
+    // with B0 empty space comes alive, and there's no end of it
+    if ((rule.birth & 1) && !engine_bounded(engine)) {
+        printf("The %s engine is unbounded, it can't run B0 rules\n", engine->name);
+        return 1;
+    }
+
+    if (!workers_start(threads)) {
+        printf("Couldn't start worker threads! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (!init_points(&points, rows, cols)) {
+        printf("Couldn't allocate a %d x %d grid!\n", cols, rows);
+        return 1;
+    }
+
+    if (pattern && !load_pattern(&points, pattern, density, seed)) {
+        printf("Couldn't load pattern '%s'!\n", pattern);
+        return 1;
+    }
+
+    if (headless) {
+        int status = run_headless(engine, pattern, generations);
+        free_points(&points);
+        workers_stop();
+        return status;
+    }
+
     // initializing SDL
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
         printf("SDL couldn't be initialized! SDL_Errow: %s\n", SDL_GetError());
         return 1;
     }
 
+    char rule_text[32];
+    format_rule(&rule, rule_text, sizeof(rule_text));
+
     // printing controls
     printf("\n          Controls\n");
     printf("\n    Right Click : Populate Cell\n");
@@ -204,11 +1080,49 @@ int main() {
     printf("    Enter       : Start Game\n");
     printf("    ESC         : Pause Game\n");
     printf("    E           : End Game\n");
+    printf("    + / -       : Faster / Slower\n");
+    printf("    0           : Unlimited Speed\n");
+    printf("    Wheel       : Zoom\n");
+    printf("    Middle Drag : Pan (or arrow keys)\n");
+    printf("    Home        : Fit Grid to Window\n");
+    printf("\n    Engine      : %s\n", engine->name);
+    printf("    Kernels     : %s\n", simd_names[simd_level]);
+    printf("    Threads     : %d\n", worker_count());
+    printf("    Grid        : %d x %d, %s boundary\n", points.cols, points.rows, boundary_names[boundary]);
+    printf("    Rule        : %s\n", rule_text);
+
+    if (unlimited) {
+        printf("    Speed       : unlimited\n");
+    } else {
+        printf("    Speed       : %g generations/s\n", speed);
+    }
+
+    if (engine == &hashlife_engine) {
+        printf("    Step        : 2^%d generations\n", hashlife_step_log2);
+    }
+
+    if (engine == &bits_engine && bits_block_generations > 1) {
+        printf("    Blocks      : %d generations\n", bits_block_generations);
+    }
 
-    SDL_Window *window = SDL_CreateWindow("Conway's Game of Life", SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+    SDL_Window *window = SDL_CreateWindow("Conway's Game of Life", SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_RESIZABLE);
     SDL_Renderer *renderer = SDL_CreateRenderer(window, NULL);
 
-    init_points();
+    if (!renderer || !init_textures(renderer)) {
+        printf("Couldn't create the renderer! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    fit_view();
+
+    sim_set_rate(unlimited ? 0 : speed);
+
+    if (!sim_start(engine, &points)) {
+        printf("Couldn't start the simulation thread! SDL_Error: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    sim_publish();
 
     int running = 1;
 
@@ -217,13 +1131,23 @@ int main() {
 
     int isMouseDown;
 
-    int generation_counter = 0;
+    // set when the window needs repainting even though no cell flipped
+    int redraw = 1;
+    char hud[128] = "";
+    const struct frame *last_frame = NULL;
 
     while(running) {
         
+        // the grid is edited, reset or handed to the engine only while the
+        // simulation thread is stopped
+        int edited = 0;
+
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
 
+            // mouse positions in render pixels, as the view is measured
+            SDL_ConvertEventToRenderCoordinates(renderer, &event);
+
             switch(event.type) {
                 case SDL_EVENT_QUIT:
                     running = 0; break;
@@ -234,13 +1158,53 @@ int main() {
                 case SDL_EVENT_MOUSE_BUTTON_UP:
                     isMouseDown = 0; break;
 
+                // target textures lose their contents, a lost device all textures
+                case SDL_EVENT_RENDER_TARGETS_RESET:
+                    draw_grid_texture(renderer);
+                    redraw = 1;
+                    break;
+
+                case SDL_EVENT_RENDER_DEVICE_RESET:
+                    free_textures();
+                    init_textures(renderer);
+                    redraw = 1;
+                    break;
+
+                case SDL_EVENT_WINDOW_EXPOSED:
+                    redraw = 1; break;
+
+                case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                    if (update_view(renderer)) {
+                        update_cells_size(renderer);
+                        redraw = 1;
+                    }
+                    break;
+
+                case SDL_EVENT_MOUSE_WHEEL:
+                    zoom_view(SDL_powf(ZOOM_STEP, event.wheel.y), event.wheel.mouse_x, event.wheel.mouse_y);
+                    redraw = 1;
+                    break;
+
+                case SDL_EVENT_MOUSE_MOTION:
+                    if (event.motion.state & SDL_BUTTON_MMASK) {
+                        pan_view(event.motion.xrel, event.motion.yrel);
+                        redraw = 1;
+                    }
+                    break;
+
                 case SDL_EVENT_KEY_DOWN:
                     if(event.key.key == SDLK_SPACE && !gameStarted) {
-                        reset_all_points();
+                        reset_all_points(&points);
+                        sim_reset_generation();
+                        edited = 1;
                     }
 
-                    if(event.key.key == SDLK_RETURN) {
-                        gameStarted = 1;
+                    if(event.key.key == SDLK_RETURN && !gameStarted) {
+                        if (engine->load(&points)) {
+                            gameStarted = 1;
+                        } else {
+                            printf("Couldn't allocate the engine's grid!\n");
+                        }
                     }
 
                     if (event.key.key == SDLK_E) {
@@ -251,45 +1215,100 @@ int main() {
                         gamePaused = (gamePaused == 0)? 1 : 0; 
                     }
 
+                    // speed: doubled or halved, 0 toggles unlimited
+                    if (event.key.key == SDLK_EQUALS || event.key.key == SDLK_PLUS || event.key.key == SDLK_KP_PLUS) {
+                        speed = unlimited ? speed : SDL_min(speed * 2, MAX_SPEED);
+                        unlimited = 0;
+                        sim_set_rate(speed);
+                    }
+
+                    if (event.key.key == SDLK_MINUS || event.key.key == SDLK_KP_MINUS) {
+                        speed = unlimited ? speed : SDL_max(speed / 2, MIN_SPEED);
+                        unlimited = 0;
+                        sim_set_rate(speed);
+                    }
+
+                    if (event.key.key == SDLK_0 || event.key.key == SDLK_KP_0) {
+                        unlimited = !unlimited;
+                        sim_set_rate(unlimited ? 0 : speed);
+                    }
+
+                    // camera: an eighth of the window per arrow press
+                    if (event.key.key == SDLK_LEFT) pan_view(view.width / 8.0f, 0);
+                    if (event.key.key == SDLK_RIGHT) pan_view(-view.width / 8.0f, 0);
+                    if (event.key.key == SDLK_UP) pan_view(0, view.height / 8.0f);
+                    if (event.key.key == SDLK_DOWN) pan_view(0, -view.height / 8.0f);
+
+                    if (event.key.key == SDLK_HOME) {
+                        fit_view();
+                    }
+
+                    redraw = 1;
+
                 default:
                     break;
             }
 
+            sim_run(gameStarted && !gamePaused);
+
             if(isMouseDown && !gameStarted) {
-                handleMouseClick(renderer, &event.button);
+                handleMouseClick(&event.button);
+                edited = 1;
             }
+        }
 
+        if (edited) {
+            sim_publish();
         }
 
-        if (!gamePaused) {
+        // the thread stopped itself, back to editing as after E
+        if (sim_failed()) {
+            printf("The engine ran out of memory!\n");
+            gameStarted = 0;
+        }
+
+        // only repaint when a cell flipped, the hud changed or the camera
+        // moved. a paused simulation publishes nothing new so the picture
+        // just stays
+        const struct frame *frame = sim_latest();
+        int fresh = frame != last_frame || redraw;
+        int density = view.cell < 1;
+        char text[128];
+
+        last_frame = frame;
+        hud_text(frame, text, sizeof(text));
+
+        // the cells texture only follows the frames while it is on screen
+        int changed = fresh && (density || update_cells_texture(frame));
 
-            
-            // re-draw white bg on each update
+        if (changed || strcmp(text, hud) != 0 || redraw) {
+            SDL_strlcpy(hud, text, sizeof(hud));
+            redraw = 0;
+
+            // white bg for the margin the grid doesn't cover
             SDL_SetRenderDrawColor(renderer, RGBA(COLOR_WHITE));
             SDL_RenderClear(renderer);
-            
-            
-
-            // draw grid
-            draw_grid(renderer);
-
-            if (gameStarted) {
-                if (generation_counter > GENERATION_SPEED){
-                    update_points();
-                    draw_points(renderer);
-                    generation_counter = 0;
-                } else {
-                    generation_counter++;
-                }
+
+            if (density) {
+                draw_density(renderer, frame, fresh);
+            } else if (update_grid_texture(renderer)) {
+                // cells with the grid on top
+                draw_points(renderer);
             }
 
-            draw_points(renderer);
+            draw_hud(renderer, hud);
+            draw_chart(renderer, frame);
+
+            SDL_RenderPresent(renderer);
         }
-        
-        SDL_RenderPresent(renderer);
-        SDL_Delay(10);
+
+        SDL_Delay(FRAME_DELAY);
         
     }
+            sim_stop();
+            free_points(&points);
+            workers_stop();
+            free_textures();
             SDL_DestroyRenderer(renderer);
             SDL_DestroyWindow(window);
             SDL_Quit();
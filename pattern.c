@@ -0,0 +1,158 @@
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_iostream.h>
+#include "life.h"
+
+// starting patterns: a few classics built in as RLE, RLE files from disk and
+// random soup. patterns are centered on the grid, which grows to fit them.
+
+struct builtin_pattern {
+    const char *name;
+    const char *rle;
+};
+
+static const struct builtin_pattern builtin_patterns[] = {
+    {"blinker", "3o!"},
+    {"glider", "bo$2bo$3o!"},
+    {"rpent", "b2o$2o$bo!"},
+    {"acorn", "bo5b$3bo3b$2o2b3o!"},
+    {"pulsar", "2b3o3b3o2b2$o4bobo4bo$o4bobo4bo$o4bobo4bo$2b3o3b3o2b2$2b3o3b3o2b$o4bobo4bo$o4bobo4bo$o4bobo4bo2$2b3o3b3o!"},
+    {"gosper", "24bo11b$22bobo11b$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o14b$2o8bo3bob2o4bobo11b$10bo5bo7bo11b$11bo3bo20b$12b2o!"},
+    {NULL, NULL}
+};
+
+
+// skip the header line and # comment lines in front of the cells
+static const char *rle_body(const char *text) {
+
+    for (;;) {
+        while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') {
+            text++;
+        }
+
+        if (*text != '#' && *text != 'x') {
+            return text;
+        }
+
+        while (*text && *text != '\n') {
+            text++;
+        }
+    }
+}
+
+// walk the runs of an RLE body. with a grid, live cells go into it offset
+// by (top, left), otherwise only the size is measured. returns 0 on
+// malformed input, and on a pattern wider or taller than MAX_GRID_SIZE, so
+// neither a run nor the position can overflow.
+static int rle_walk(const char *body, struct grid *grid, int top, int left, int *width, int *height) {
+
+    int x = 0, y = 0;
+    int run = 0;
+
+    *width = 0;
+    *height = 0;
+
+    for (const char *p = body; *p && *p != '!'; p++) {
+        char c = *p;
+
+        if (c >= '0' && c <= '9') {
+            run = run * 10 + (c - '0');
+
+            if (run > MAX_GRID_SIZE) {
+                return 0;
+            }
+            continue;
+        }
+
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            continue;
+        }
+
+        int count = run ? run : 1;
+        run = 0;
+
+        // x and y never pass MAX_GRID_SIZE
+        if (c == '$' ? y + count > MAX_GRID_SIZE : x + count > MAX_GRID_SIZE) {
+            return 0;
+        }
+
+        if (c == '$') {
+            y += count;
+            x = 0;
+        } else if (c == 'b' || c == '.') {
+            x += count;
+        } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '*') {
+            // every other state letter counts as alive
+            for (int i = 0; i < count; i++, x++) {
+                int row = top + y, col = left + x;
+
+                if (grid && row >= 0 && row < grid->rows && col >= 0 && col < grid->cols) {
+                    set_point(grid, row, col, 1);
+                }
+            }
+
+            *width = SDL_max(*width, x);
+            *height = y + 1;
+        } else {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int load_rle(struct grid *grid, const char *rle) {
+
+    const char *body = rle_body(rle);
+    int width, height;
+
+    if (!rle_walk(body, NULL, 0, 0, &width, &height)) {
+        return 0;
+    }
+
+    if (width > grid->cols || height > grid->rows) {
+        if (!init_points(grid, SDL_max(grid->rows, height), SDL_max(grid->cols, width))) {
+            return 0;
+        }
+    }
+
+    reset_all_points(grid);
+
+    return rle_walk(body, grid, (grid->rows - height) / 2, (grid->cols - width) / 2, &width, &height);
+}
+
+void load_soup(struct grid *grid, double density, uint64_t seed) {
+
+    for (int row = 0; row < grid->rows; row++) {
+        uint8_t *cells = grid_row(grid, row);
+
+        for (int col = 0; col < grid->cols; col++) {
+            cells[col] = SDL_randf_r(&seed) < density;
+        }
+    }
+}
+
+int load_pattern(struct grid *grid, const char *name, double density, uint64_t seed) {
+
+    if (SDL_strcmp(name, "soup") == 0) {
+        load_soup(grid, density, seed);
+        return 1;
+    }
+
+    for (int i = 0; builtin_patterns[i].name; i++) {
+        if (SDL_strcmp(name, builtin_patterns[i].name) == 0) {
+            return load_rle(grid, builtin_patterns[i].rle);
+        }
+    }
+
+    // anything else is an RLE file
+    char *text = SDL_LoadFile(name, NULL);
+
+    if (!text) {
+        return 0;
+    }
+
+    int ok = load_rle(grid, text);
+    SDL_free(text);
+
+    return ok;
+}
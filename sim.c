@@ -0,0 +1,523 @@
+#include <stdio.h>
+#include <SDL3/SDL_stdinc.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_timer.h>
+#include "life.h"
+
+// the simulation runs on its own thread and hands finished generations to
+// the renderer through a lock-free triple buffer: the writer fills its back
+// frame and swaps it with the shared middle one, the reader swaps the middle
+// one with its front frame whenever it holds something newer. neither side
+// ever waits for the other.
+//
+// the mutex below only guards starting and stopping the simulation. while it
+// is stopped the caller owns the grid and the engine, and publishes its
+// edits with sim_publish() itself.
+//
+// speed is a fixed timestep against the performance counter: generation n
+// is due n / rate seconds after the rate took effect. when the engine falls
+// behind it runs several generations in a row and only publishes the last
+// one, and past MAX_BACKLOG_MS behind it gives up on catching up.
+//
+// every step's population, births and deaths go into sim_stats, which
+// every frame carries a copy of for the HUD.
+//
+// once the universe turns periodic the thread caches one period of packed
+// grids and replays them instead of stepping. stopping hands the replayed
+// generation back to the grid and the engine, and the next run starts
+// looking for a cycle afresh.
+//
+// an engine that runs out of memory stops the thread as if sim_run(0) had
+// been called, and sim_failed() tells the caller.
+
+#define FRAME_FRESH 4 // set in sim_middle while the reader hasn't taken it
+
+#define BATCH_MS 16       // publish at least this often while catching up
+#define MAX_BACKLOG_MS 250
+#define MEASURE_MS 500    // window for the rate shown in the HUD
+
+// the most a period's packed grids may take. a longer period is stepped
+// like any other universe instead of replayed
+#define MAX_CYCLE_CACHE ((uint64_t)512 << 20)
+
+static struct frame frames[3];
+static SDL_AtomicInt sim_middle;
+static int sim_back = 0;  // writer's frame
+static int sim_front = 1; // reader's frame
+
+static const struct engine *sim_engine;
+static struct grid *sim_grid;
+static uint64_t sim_generation;
+static double sim_measured; // generations per second actually reached
+
+// target generations per second times 1000, 0 for as fast as possible
+static SDL_AtomicInt sim_rate_milli;
+
+// the cycle being watched for, and the grids of its period once found:
+// sim_cycle_frames of them, sim_cycle_step generations apart
+static struct cycle sim_cycle;
+static uint64_t *sim_cycle_cells;
+static struct life_stats *sim_cycle_stats; // of each cached grid
+static int sim_cycle_frames;
+static uint64_t sim_cycle_step;
+static int sim_cycle_failed; // the cache didn't fit, just keep stepping
+static int sim_replaying;
+static int sim_replay_at;    // cached grid of sim_generation while replaying
+
+static struct stats_history sim_stats;
+
+static SDL_Thread *sim_thread;
+static SDL_Mutex *sim_lock;
+static SDL_Condition *sim_wake;
+static int sim_want_running; // requested by the caller
+static int sim_is_running;   // the thread is between load and its last publish
+static int sim_quit;
+static SDL_AtomicInt sim_out_of_memory;
+
+
+static void unpack_points(const uint64_t *bits, int words) {
+
+    for (int row = 0; row < sim_grid->rows; row++) {
+        const uint64_t *in = bits + (size_t)row * words;
+        uint8_t *cells = grid_row(sim_grid, row);
+
+        for (int col = 0; col < sim_grid->cols; col++) {
+            cells[col] = (in[col / 64] >> (col % 64)) & 1;
+        }
+    }
+}
+
+static uint64_t *cycle_grid(int index) {
+    return sim_cycle_cells + (size_t)index * sim_grid->rows * frames[0].words;
+}
+
+// the population of the grid edited while stopped
+static uint64_t frame_population(const struct frame *frame) {
+
+    uint64_t population = 0;
+
+    for (size_t w = 0; w < (size_t)frame->rows * frame->words; w++) {
+        population += life_popcount(frame->bits[w]);
+    }
+
+    return population;
+}
+
+void sim_publish(void) {
+
+    struct frame *frame = &frames[sim_back];
+
+    // packed straight from the engine while it runs, the grid is only
+    // stored when the thread stops
+    if (sim_replaying) {
+        SDL_memcpy(frame->bits, cycle_grid(sim_replay_at), (size_t)frame->rows * frame->words * sizeof(uint64_t));
+    } else if (sim_is_running) {
+        engine_pack(sim_engine, sim_grid, frame->bits, frame->words);
+    } else {
+        pack_grid(sim_grid, frame->bits, frame->words);
+    }
+
+    frame->digest = digest_rows(frame->bits, frame->words, frame->rows, frame->cols);
+
+    // the grid edited while stopped, its history starts over from here
+    if (!sim_is_running) {
+        struct life_stats stats = {sim_generation, frame_population(frame), 0, 0, 0};
+
+        stats_reset(&sim_stats);
+        stats_record(&sim_stats, &stats);
+    }
+
+    frame->generation = sim_generation;
+    frame->rate = sim_measured;
+    frame->stats = sim_stats;
+
+    if (sim_replaying) {
+        SDL_snprintf(frame->status, sizeof(frame->status), "period %" SDL_PRIu64 " since gen %" SDL_PRIu64,
+                     sim_cycle.period, sim_cycle.start);
+    } else {
+        engine_status(sim_engine, frame->status, sizeof(frame->status));
+    }
+
+    sim_back = SDL_SetAtomicInt(&sim_middle, sim_back | FRAME_FRESH) & ~FRAME_FRESH;
+}
+
+const struct frame *sim_latest(void) {
+
+    if (SDL_GetAtomicInt(&sim_middle) & FRAME_FRESH) {
+        sim_front = SDL_SetAtomicInt(&sim_middle, sim_front) & ~FRAME_FRESH;
+    }
+
+    return &frames[sim_front];
+}
+
+static void sim_forget_cycle(void) {
+
+    cycle_reset(&sim_cycle);
+    SDL_free(sim_cycle_cells);
+    SDL_free(sim_cycle_stats);
+    sim_cycle_cells = NULL;
+    sim_cycle_stats = NULL;
+    sim_cycle_frames = 0;
+    sim_cycle_failed = 0;
+    sim_replaying = 0;
+}
+
+// the grid at sim_generation
+static void sim_store(void) {
+
+    if (sim_replaying) {
+        unpack_points(cycle_grid(sim_replay_at), frames[0].words);
+    } else {
+        sim_engine->store(sim_grid);
+    }
+}
+
+static int sim_watching(void) {
+    return detect_cycles && engine_bounded(sim_engine) && !sim_cycle_failed;
+}
+
+// feed the cycle detector, and once it found one cache the period from here on
+static void sim_watch(uint32_t digest, uint64_t step) {
+
+    if (!sim_cycle.period) {
+        if (!cycle_update(&sim_cycle, sim_generation, digest)) {
+            return;
+        }
+
+        uint64_t grid_size = (uint64_t)sim_grid->rows * frames[0].words * sizeof(uint64_t);
+        uint64_t count = sim_cycle.period / step;
+
+        // checked before asking, an overcommitting malloc would say yes to
+        // anything and the cache would run out of memory while filling
+        if (sim_cycle.period % step || count > MAX_CYCLE_CACHE / grid_size) {
+            sim_cycle_failed = 1;
+            return;
+        }
+
+        sim_cycle_step = step;
+        sim_cycle_cells = SDL_malloc((size_t)(count * grid_size));
+        sim_cycle_stats = SDL_malloc((size_t)count * sizeof(*sim_cycle_stats));
+
+        if (!sim_cycle_cells || !sim_cycle_stats) {
+            sim_cycle_failed = 1;
+            return;
+        }
+    }
+
+    sim_engine->stats(&sim_cycle_stats[sim_cycle_frames]);
+    engine_pack(sim_engine, sim_grid, cycle_grid(sim_cycle_frames++), frames[0].words);
+
+    if ((uint64_t)sim_cycle_frames * sim_cycle_step == sim_cycle.period) {
+        sim_replaying = 1;
+        sim_replay_at = sim_cycle_frames - 1;
+    }
+}
+
+// stop where the engine left off, it couldn't step any further
+static void sim_fail(void) {
+
+    SDL_LockMutex(sim_lock);
+    sim_want_running = 0;
+    SDL_UnlockMutex(sim_lock);
+
+    SDL_SetAtomicInt(&sim_out_of_memory, 1);
+}
+
+// one step of the engine, or of the replay. 0 if the engine ran out of memory
+static int sim_step(void) {
+
+    struct life_stats stats;
+
+    if (sim_replaying) {
+        sim_replay_at = (sim_replay_at + 1) % sim_cycle_frames;
+        sim_generation += sim_cycle_step;
+
+        stats = sim_cycle_stats[sim_replay_at];
+        stats.generation = sim_generation;
+        stats_record(&sim_stats, &stats);
+
+        if (log_digests) {
+            printf("generation %" SDL_PRIu64 " digest %08" SDL_PRIx32 "\n", sim_generation,
+                   digest_rows(cycle_grid(sim_replay_at), frames[0].words, sim_grid->rows, sim_grid->cols));
+        }
+        return 1;
+    }
+
+    // single generations while the detector narrows a period down and the
+    // period is cached
+    int single = sim_watching() && (sim_cycle.multiple || sim_cycle.period);
+    uint64_t step = engine_step_within(sim_engine, single ? 1 : UINT64_MAX);
+
+    if (!step) {
+        return 0;
+    }
+
+    sim_generation += step;
+
+    sim_engine->stats(&stats);
+    stats.generation = sim_generation;
+    stats_record(&sim_stats, &stats);
+
+    // once periodic every grid of the period is cached
+    int watch = sim_watching() && (sim_cycle.period || cycle_due(&sim_cycle, sim_generation));
+
+    if (!log_digests && !watch) {
+        return 1;
+    }
+
+    uint32_t digest = engine_digest(sim_engine, sim_grid);
+
+    if (log_digests) {
+        printf("generation %" SDL_PRIu64 " digest %08" SDL_PRIx32 "\n", sim_generation, digest);
+    }
+
+    if (watch) {
+        sim_watch(digest, step);
+    }
+
+    return 1;
+}
+
+static int sim_main(void *data) {
+
+    (void)data;
+
+    double freq = (double)SDL_GetPerformanceFrequency();
+
+    int anchored = 0;
+    int anchor_rate = 0;
+    Uint64 anchor = 0;      // when the current rate took effect
+    uint64_t done = 0;      // generations run since then
+
+    Uint64 window_start = 0;
+    uint64_t window_generation = 0;
+
+    SDL_LockMutex(sim_lock);
+
+    for (;;) {
+        while (!sim_want_running && !sim_quit) {
+            if (sim_is_running) {
+                // leave the grid, the engine and the newest frame at the
+                // last generation. the engine already has the grid's size
+                // so loading it can't run out of memory
+                sim_store();
+
+                if (sim_replaying) {
+                    sim_engine->load(sim_grid);
+                }
+
+                sim_forget_cycle();
+                sim_publish();
+                sim_is_running = 0;
+                SDL_BroadcastCondition(sim_wake);
+            }
+
+            // start counting afresh when resumed
+            anchored = 0;
+
+            SDL_WaitCondition(sim_wake, sim_lock);
+        }
+
+        if (sim_quit) {
+            break;
+        }
+
+        sim_is_running = 1;
+        SDL_UnlockMutex(sim_lock);
+
+        int rate = SDL_GetAtomicInt(&sim_rate_milli);
+        Uint64 now = SDL_GetPerformanceCounter();
+
+        if (!anchored || rate != anchor_rate) {
+            if (!anchored) {
+                sim_measured = 0;
+
+                // the grid may have been edited or reloaded while stopped
+                sim_forget_cycle();
+
+                if (sim_watching()) {
+                    cycle_update(&sim_cycle, sim_generation, engine_digest(sim_engine, sim_grid));
+                }
+            }
+
+            anchored = 1;
+            anchor_rate = rate;
+            anchor = now;
+            done = 0;
+            window_start = now;
+            window_generation = sim_generation;
+        }
+
+        uint64_t start_generation = sim_generation;
+        int wait_ms = 0;
+
+        if (rate == 0) {
+            // unlimited, one generation per pass. a replay has nothing to
+            // compute and goes at the renderer's pace
+            if (sim_replaying && (SDL_GetAtomicInt(&sim_middle) & FRAME_FRESH)) {
+                wait_ms = 1;
+            } else if (!sim_step()) {
+                sim_fail();
+            }
+        } else {
+            // the first generation is due right away, then one every 1 / rate seconds
+            uint64_t due = (uint64_t)((now - anchor) / freq * rate / 1000) + 1;
+            Uint64 batch_end = now + (Uint64)(freq * BATCH_MS / 1000);
+
+            while (done < due && SDL_GetPerformanceCounter() < batch_end) {
+                uint64_t before = sim_generation;
+
+                if (!sim_step()) {
+                    sim_fail();
+                    break;
+                }
+
+                done += sim_generation - before;
+            }
+
+            now = SDL_GetPerformanceCounter();
+
+            // ms until the next generation is due
+            double ahead = done * 1e6 / rate - (now - anchor) * 1000 / freq;
+
+            if (ahead > 0) {
+                wait_ms = (int)SDL_ceil(ahead);
+            } else if (-ahead > MAX_BACKLOG_MS) {
+                // too far behind to ever catch up, drop the backlog
+                anchor = now;
+                done = 0;
+            }
+        }
+
+        now = SDL_GetPerformanceCounter();
+
+        if ((now - window_start) * 1000 >= freq * MEASURE_MS) {
+            sim_measured = (sim_generation - window_generation) * freq / (now - window_start);
+            window_start = now;
+            window_generation = sim_generation;
+        }
+
+        // only publish once the renderer took the previous frame, or when
+        // about to wait for the next generation anyway
+        int fresh = SDL_GetAtomicInt(&sim_middle) & FRAME_FRESH;
+
+        if (sim_generation != start_generation && (!fresh || wait_ms > 0)) {
+            sim_publish();
+        }
+
+        SDL_LockMutex(sim_lock);
+
+        // sim_set_rate() and sim_run() cut the wait short
+        if (wait_ms > 0 && sim_want_running && !sim_quit) {
+            SDL_WaitConditionTimeout(sim_wake, sim_lock, wait_ms);
+        }
+    }
+
+    SDL_UnlockMutex(sim_lock);
+
+    return 0;
+}
+
+int sim_start(const struct engine *engine, struct grid *grid) {
+
+    sim_engine = engine;
+    sim_grid = grid;
+    sim_generation = 0;
+    SDL_SetAtomicInt(&sim_middle, 2);
+
+    for (int i = 0; i < 3; i++) {
+        struct frame *frame = &frames[i];
+
+        frame->rows = grid->rows;
+        frame->cols = grid->cols;
+        frame->words = (grid->cols + 63) / 64;
+        frame->bits = SDL_calloc((size_t)frame->rows * frame->words, sizeof(uint64_t));
+
+        if (!frame->bits) {
+            return 0;
+        }
+    }
+
+    sim_lock = SDL_CreateMutex();
+    sim_wake = SDL_CreateCondition();
+
+    if (!sim_lock || !sim_wake) {
+        return 0;
+    }
+
+    sim_thread = SDL_CreateThread(sim_main, "life sim", NULL);
+
+    return sim_thread != NULL;
+}
+
+void sim_stop(void) {
+
+    if (sim_thread) {
+        SDL_LockMutex(sim_lock);
+        sim_quit = 1;
+        SDL_BroadcastCondition(sim_wake);
+        SDL_UnlockMutex(sim_lock);
+
+        SDL_WaitThread(sim_thread, NULL);
+        sim_thread = NULL;
+    }
+
+    sim_forget_cycle();
+
+    SDL_DestroyCondition(sim_wake);
+    SDL_DestroyMutex(sim_lock);
+    sim_wake = NULL;
+    sim_lock = NULL;
+
+    for (int i = 0; i < 3; i++) {
+        SDL_free(frames[i].bits);
+        frames[i].bits = NULL;
+    }
+}
+
+void sim_run(int run) {
+
+    SDL_LockMutex(sim_lock);
+
+    sim_want_running = run;
+    SDL_BroadcastCondition(sim_wake);
+
+    // stopping waits until the thread has let go of the grid
+    while (!run && sim_is_running) {
+        SDL_WaitCondition(sim_wake, sim_lock);
+    }
+
+    SDL_UnlockMutex(sim_lock);
+}
+
+void sim_reset_generation(void) {
+    sim_generation = 0;
+}
+
+void sim_set_rate(double rate) {
+
+    // up to SDL_MAX_SINT32 / 1000 generations per second, anything above is unlimited
+    int milli = 0;
+
+    if (rate > 0 && rate * 1000 < SDL_MAX_SINT32) {
+        milli = SDL_max((int)(rate * 1000 + 0.5), 1);
+    }
+
+    SDL_SetAtomicInt(&sim_rate_milli, milli);
+
+    if (sim_lock) {
+        SDL_LockMutex(sim_lock);
+        SDL_BroadcastCondition(sim_wake);
+        SDL_UnlockMutex(sim_lock);
+    }
+}
+
+int sim_failed(void) {
+    return SDL_SetAtomicInt(&sim_out_of_memory, 0);
+}
+
+double sim_rate(void) {
+    return SDL_GetAtomicInt(&sim_rate_milli) / 1000.0;
+}
@@ -0,0 +1,403 @@
+#include <stdint.h>
+#include <SDL3/SDL_stdinc.h>
+#include "life.h"
+
+// sparse engine: an unbounded universe of 64x64 bit-packed tiles, looked up
+// by tile coordinate in an open addressing hash map. a tile is allocated
+// when live cells reach its border and freed when it goes empty, so memory
+// follows the live area instead of the bounding box.
+//
+// like hashlife, the grid is the window from (0, 0) to (cols, rows).
+
+#define TILE_SIZE 64
+
+struct tile {
+    int64_t tx, ty;               // cell (x, y) is in tile (x / 64, y / 64), rounded down
+    uint64_t rows[2][TILE_SIZE];  // bit i of a row is column i, [sparse_parity] is current
+    int index;                    // in sparse_tiles
+};
+
+static int sparse_parity;
+static int sparse_life; // B3/S23, with its rule folded into the kernel
+static struct life_stats sparse_stats; // of the whole universe
+static int sparse_rows, sparse_cols; // of the grid loaded, the window pack() shows
+
+// the hash map, linear probing with backward shift deletion
+static struct tile **sparse_slots;
+static size_t sparse_capacity;
+
+// every tile, for iteration
+static struct tile **sparse_tiles;
+static int sparse_count;
+static int sparse_allocated;
+
+
+// tile holding cell coordinate a, rounding down for negative coordinates
+static int64_t tile_coord(int64_t a) {
+    return a >= 0 ? a / TILE_SIZE : -((-a + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+static size_t sparse_hash(int64_t tx, int64_t ty) {
+
+    uint64_t h = (uint64_t)tx * 0x9E3779B97F4A7C15ULL ^ (uint64_t)ty * 0xC2B2AE3D27D4EB4FULL;
+
+    return (size_t)(h ^ (h >> 32));
+}
+
+static struct tile *sparse_find(int64_t tx, int64_t ty) {
+
+    if (!sparse_capacity) {
+        return NULL;
+    }
+
+    size_t mask = sparse_capacity - 1;
+
+    for (size_t i = sparse_hash(tx, ty) & mask; sparse_slots[i]; i = (i + 1) & mask) {
+        if (sparse_slots[i]->tx == tx && sparse_slots[i]->ty == ty) {
+            return sparse_slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void sparse_place(struct tile *t) {
+
+    size_t mask = sparse_capacity - 1;
+    size_t i = sparse_hash(t->tx, t->ty) & mask;
+
+    while (sparse_slots[i]) {
+        i = (i + 1) & mask;
+    }
+
+    sparse_slots[i] = t;
+}
+
+// 0 if out of memory, the map is left as it was
+static int sparse_grow(void) {
+
+    size_t capacity = sparse_capacity ? sparse_capacity * 2 : 256;
+    struct tile **slots = SDL_calloc(capacity, sizeof(*slots));
+    struct tile **tiles = slots ? SDL_realloc(sparse_tiles, capacity / 2 * sizeof(*tiles)) : NULL;
+
+    if (!tiles) {
+        SDL_free(slots);
+        return 0;
+    }
+
+    SDL_free(sparse_slots);
+    sparse_slots = slots;
+    sparse_capacity = capacity;
+    sparse_tiles = tiles;
+    sparse_allocated = capacity / 2;
+
+    for (int i = 0; i < sparse_count; i++) {
+        sparse_place(sparse_tiles[i]);
+    }
+
+    return 1;
+}
+
+// the tile at (tx, ty), allocated empty if there is none yet. NULL if out
+// of memory
+static struct tile *sparse_get(int64_t tx, int64_t ty) {
+
+    struct tile *t = sparse_find(tx, ty);
+
+    if (t) {
+        return t;
+    }
+
+    // keep the map at most half full
+    if (sparse_count + 1 > sparse_allocated && !sparse_grow()) {
+        return NULL;
+    }
+
+    t = SDL_calloc(1, sizeof(*t));
+
+    if (!t) {
+        return NULL;
+    }
+
+    t->tx = tx;
+    t->ty = ty;
+    t->index = sparse_count;
+    sparse_tiles[sparse_count++] = t;
+    sparse_place(t);
+
+    return t;
+}
+
+static void sparse_remove(struct tile *t) {
+
+    size_t mask = sparse_capacity - 1;
+    size_t i = sparse_hash(t->tx, t->ty) & mask;
+
+    while (sparse_slots[i] != t) {
+        i = (i + 1) & mask;
+    }
+
+    // pull later entries of the probe run back over the hole
+    size_t hole = i;
+
+    for (size_t j = (i + 1) & mask; sparse_slots[j]; j = (j + 1) & mask) {
+        size_t home = sparse_hash(sparse_slots[j]->tx, sparse_slots[j]->ty) & mask;
+
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            sparse_slots[hole] = sparse_slots[j];
+            hole = j;
+        }
+    }
+
+    sparse_slots[hole] = NULL;
+
+    // swap remove from the tile list
+    struct tile *last = sparse_tiles[--sparse_count];
+    sparse_tiles[t->index] = last;
+    last->index = t->index;
+
+    SDL_free(t);
+}
+
+static void sparse_clear(void) {
+
+    while (sparse_count) {
+        sparse_remove(sparse_tiles[sparse_count - 1]);
+    }
+}
+
+static int tile_empty(const struct tile *t) {
+
+    const uint64_t *rows = t->rows[sparse_parity];
+    uint64_t any = 0;
+
+    for (int r = 0; r < TILE_SIZE; r++) {
+        any |= rows[r];
+    }
+
+    return any == 0;
+}
+
+
+// make sure every tile that live cells can spread into next generation
+// exists, 0 if out of memory
+static int sparse_reserve(void) {
+
+    int count = sparse_count;
+    int ok = 1;
+
+    for (int i = 0; i < count; i++) {
+        struct tile *t = sparse_tiles[i];
+        const uint64_t *rows = t->rows[sparse_parity];
+
+        uint64_t sides = 0;
+        for (int r = 0; r < TILE_SIZE; r++) {
+            sides |= rows[r];
+        }
+
+        if (!sides) {
+            continue;
+        }
+
+        int north = rows[0] != 0;
+        int south = rows[TILE_SIZE - 1] != 0;
+        int west = (sides & 1) != 0;
+        int east = (sides >> 63) != 0;
+
+        // corners only need a diagonal tile if the corner cell itself is alive
+        int nw = rows[0] & 1, ne = rows[0] >> 63;
+        int sw = rows[TILE_SIZE - 1] & 1, se = rows[TILE_SIZE - 1] >> 63;
+
+        if (north) ok &= sparse_get(t->tx, t->ty - 1) != NULL;
+        if (south) ok &= sparse_get(t->tx, t->ty + 1) != NULL;
+        if (west) ok &= sparse_get(t->tx - 1, t->ty) != NULL;
+        if (east) ok &= sparse_get(t->tx + 1, t->ty) != NULL;
+        if (nw) ok &= sparse_get(t->tx - 1, t->ty - 1) != NULL;
+        if (ne) ok &= sparse_get(t->tx + 1, t->ty - 1) != NULL;
+        if (sw) ok &= sparse_get(t->tx - 1, t->ty + 1) != NULL;
+        if (se) ok &= sparse_get(t->tx + 1, t->ty + 1) != NULL;
+    }
+
+    return ok;
+}
+
+// row r (-1 to 64) of the tile dx tiles to the side of the middle column
+static uint64_t tile_row(struct tile *around[3][3], int dx, int r) {
+
+    struct tile *t;
+
+    if (r < 0) {
+        t = around[0][dx + 1];
+        r += TILE_SIZE;
+    } else if (r >= TILE_SIZE) {
+        t = around[2][dx + 1];
+        r -= TILE_SIZE;
+    } else {
+        t = around[1][dx + 1];
+    }
+
+    return t ? t->rows[sparse_parity][r] : 0;
+}
+
+static void tile_step(struct tile *t) {
+
+    struct tile *around[3][3];
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            around[dy + 1][dx + 1] = sparse_find(t->tx + dx, t->ty + dy);
+        }
+    }
+
+    uint64_t *out = t->rows[!sparse_parity];
+
+    // three words of the rows above, at and below, slid down one row at a time
+    uint64_t up[3], mid[3], down[3];
+
+    for (int dx = -1; dx <= 1; dx++) {
+        up[dx + 1] = tile_row(around, dx, -1);
+        mid[dx + 1] = tile_row(around, dx, 0);
+    }
+
+    for (int r = 0; r < TILE_SIZE; r++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            down[dx + 1] = tile_row(around, dx, r + 1);
+        }
+
+        out[r] = sparse_life ? rule_word(up, mid, down, 1, LIFE_BIRTH, LIFE_SURVIVE)
+                             : rule_word(up, mid, down, 1, rule.birth, rule.survive);
+
+        uint64_t changed = out[r] ^ mid[1];
+
+        if (changed) {
+            sparse_stats.births += life_popcount(changed & out[r]);
+            sparse_stats.deaths += life_popcount(changed & mid[1]);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            up[i] = mid[i];
+            mid[i] = down[i];
+        }
+    }
+}
+
+// out of memory nothing is stepped. the empty tiles already added go with
+// the next step that gets through
+static uint64_t sparse_step(void) {
+
+    if (!sparse_reserve()) {
+        return 0;
+    }
+
+    sparse_stats.births = sparse_stats.deaths = 0;
+
+    for (int i = 0; i < sparse_count; i++) {
+        tile_step(sparse_tiles[i]);
+    }
+
+    sparse_parity = !sparse_parity;
+    sparse_stats.population += sparse_stats.births - sparse_stats.deaths;
+
+    // free whatever went empty, walking backwards since removal swaps the last tile in
+    for (int i = sparse_count - 1; i >= 0; i--) {
+        if (tile_empty(sparse_tiles[i])) {
+            sparse_remove(sparse_tiles[i]);
+        }
+    }
+
+    return 1;
+}
+
+int sparse_tile_count(void) {
+    return sparse_count;
+}
+
+static int sparse_load(struct grid *grid) {
+
+    sparse_clear();
+    sparse_life = rule_is(&rule, LIFE_BIRTH, LIFE_SURVIVE);
+    sparse_stats = (struct life_stats){.counted = 1};
+    sparse_rows = grid->rows;
+    sparse_cols = grid->cols;
+
+    for (int row = 0; row < grid->rows; row++) {
+        const uint8_t *cells = grid_row(grid, row);
+
+        for (int col = 0; col < grid->cols; col++) {
+            if (1 == cells[col]) {
+                struct tile *t = sparse_get(tile_coord(col), tile_coord(row));
+
+                if (!t) {
+                    sparse_clear();
+                    return 0;
+                }
+
+                t->rows[sparse_parity][row - t->ty * TILE_SIZE] |= 1ULL << (col - t->tx * TILE_SIZE);
+                sparse_stats.population++;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static void sparse_store(struct grid *grid) {
+
+    reset_all_points(grid);
+
+    for (int i = 0; i < sparse_count; i++) {
+        struct tile *t = sparse_tiles[i];
+
+        for (int r = 0; r < TILE_SIZE; r++) {
+            int64_t row = t->ty * TILE_SIZE + r;
+            uint64_t bits = t->rows[sparse_parity][r];
+
+            if (row < 0 || row >= grid->rows || !bits) {
+                continue;
+            }
+
+            for (int c = 0; c < TILE_SIZE; c++) {
+                int64_t col = t->tx * TILE_SIZE + c;
+
+                if (col >= 0 && col < grid->cols) {
+                    set_point(grid, (int)row, (int)col, (bits >> c) & 1);
+                }
+            }
+        }
+    }
+}
+
+// a tile row is a whole word of a packed row, tile x is word x
+static void sparse_pack(uint64_t *bits, int words) {
+
+    int used = sparse_cols - (words - 1) * 64;
+
+    SDL_memset(bits, 0, (size_t)sparse_rows * words * sizeof(uint64_t));
+
+    for (int i = 0; i < sparse_count; i++) {
+        struct tile *t = sparse_tiles[i];
+
+        if (t->tx < 0 || t->tx >= words) {
+            continue;
+        }
+
+        for (int r = 0; r < TILE_SIZE; r++) {
+            int64_t row = t->ty * TILE_SIZE + r;
+
+            if (row >= 0 && row < sparse_rows) {
+                bits[row * words + t->tx] = t->rows[sparse_parity][r];
+            }
+        }
+    }
+
+    // cells past the last column
+    for (int row = 0; row < sparse_rows && used < 64; row++) {
+        bits[(size_t)row * words + words - 1] &= (1ULL << used) - 1;
+    }
+}
+
+static void sparse_get_stats(struct life_stats *stats) {
+    *stats = sparse_stats;
+}
+
+const struct engine sparse_engine = {"sparse", sparse_load, sparse_step, sparse_store, NULL, sparse_pack, sparse_get_stats};
@@ -1,302 +1,437 @@
 #include <stdio.h>
-#include <SDL3/SDL.h>
-#include <SDL3/SDL_ttf.h>
+#include <string.h>
+#include <SDL3/SDL_stdinc.h>
+#include "life.h"
+
+// regression test: known patterns through every engine, every kernel level
+// of the ones with vector kernels and a few thread counts, checked
+// generation by generation against the naive update_points() reference,
+// their population, births and deaths too.
+// exits with 1 if anything failed.
+//
+// the default grid is big enough that nothing reaches the border by the
+// last generation, which is where the unbounded engines would part ways with
+// the bounded ones. cases on a grid of their own run into its edges on
+// purpose and only go through the bounded engines, dead or wrapped around,
+// which are also the only ones that can run B0 rules.
+#define TEST_ROWS 800
+#define TEST_COLS 1200
+
+struct test_case {
+    const char *pattern;
+    int generations;
+    int population; // known population after the last generation
+    int period;     // oscillators: the period cycle_update() has to find
+    int rows, cols; // a grid of its own, odd sizes leave partial words and blocks
+    enum boundary boundary;
+    const char *rule; // NULL for Life
+};
 
-#define SCREEN_WIDTH 1200
-#define SCREEN_HEIGHT 800
+static const struct test_case test_cases[] = {
+    {"blinker", 10, 3, 2, 0, 0, BOUNDARY_DEAD, NULL},
+    {"glider", 100, 5, 0, 0, 0, BOUNDARY_DEAD, NULL},
+    {"pulsar", 60, 48, 3, 0, 0, BOUNDARY_DEAD, NULL},
+    {"rpent", 1103, 116, 0, 0, 0, BOUNDARY_DEAD, NULL},
+    {"gosper", 600, 46, 60, 45, 67, BOUNDARY_DEAD, NULL},
+    {"glider", 400, 5, 120, 15, 30, BOUNDARY_TORUS, NULL}, // back where it started every 4 * 30 generations
+    {"gosper", 600, 168, 0, 45, 67, BOUNDARY_TORUS, NULL},
+    {"rpent", 1500, 356, 0, 64, 128, BOUNDARY_TORUS, NULL},
+    {"acorn", 300, 95, 0, 0, 0, BOUNDARY_DEAD, "highlife"},
+    {"acorn", 200, 7086, 0, 0, 0, BOUNDARY_DEAD, "B3/S012345678"}, // no kernels of its own
+    {"rpent", 100, 5, 16, 45, 67, BOUNDARY_DEAD, "daynight"},
+    {"glider", 100, 594, 0, 45, 67, BOUNDARY_TORUS, "seeds"},
+    {"gosper", 300, 2410, 0, 45, 67, BOUNDARY_DEAD, "B0123478/S34678"},
+};
 
-#define RGBA(c) \
-    ((c >> 24) & 0xFF), \
-    ((c >> 16) & 0xFF), \
-    ((c >> 8) & 0xFF), \
-    (c & 0xFF)
+static const int test_threads[] = {1, 4};
 
+// hashlife is also run in jumps, checked wherever a jump lands
+static const int test_hashlife_steps[] = {0, 4};
 
-#define COLOR_WHITE 0xFFFFFFFF
-#define COLOR_GRAY 0xB0B0B0FF
-#define COLOR_BLACK 0x000000FF
+// and bits in blocks of generations, some longer than a small grid is high
+static const int test_bits_blocks[] = {1, 7};
 
-#define CELL_SIZE 18
-#define ROWS SCREEN_HEIGHT / CELL_SIZE
-#define COLS SCREEN_WIDTH / CELL_SIZE
-#define GRIDLINE_WIDTH 1
+static uint32_t *reference_digest;
+static uint64_t *reference_population;
+static int *reference_births, *reference_deaths;
 
-#define GENERATION_SPEED 8 // once each 10 game loop iteration
+static uint64_t reference_start; // of the cycle, if any
 
-struct point {
-    int row, col;
-    int state; // 0 is dead, 1 is alive
-};
+static struct grid points, previous;
 
+static int failures;
 
-struct point points[ROWS][COLS];
 
+// live cells on the outermost rows or columns
+static int touches_border(void) {
 
-void init_points(){
+    int live = 0;
 
-    // store points
-    for (int row = 0; row < ROWS; row++) {
-        for(int col = 0; col < COLS; col++) {
-            points[row][col].row = row;
-            points[row][col].col = col;
-            points[row][col]. state = 0;
-        }
+    for (int col = 0; col < points.cols; col++) {
+        live += get_point(&points, 0, col) + get_point(&points, points.rows - 1, col);
+    }
 
+    for (int row = 0; row < points.rows; row++) {
+        live += get_point(&points, row, 0) + get_point(&points, row, points.cols - 1);
     }
+
+    return live > 0;
 }
 
+// what an engine counted against the reference
+static int stats_agree(const struct engine *engine, int generation) {
 
-// update points
-void update_points() {
-    int next_state[ROWS][COLS];
+    struct life_stats stats;
+    engine->stats(&stats);
 
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            int total_alive_neighbors = 0;
+    return stats.population == reference_population[generation] &&
+           (!stats.counted || (stats.births == (uint64_t)reference_births[generation] &&
+                               stats.deaths == (uint64_t)reference_deaths[generation]));
+}
 
-            // for neighbors
-            for (int x = -1; x <= 1; x++) {
-                for (int y = -1; y <= 1; y++) {
-                    if (x == 0 && y == 0) continue; // skip itself
+static void run_reference(const struct test_case *test) {
 
-                    int neigh_r = row + x;
-                    int neigh_c = col + y;
+    int warned = 0;
 
-                    if (neigh_r >= 0 && neigh_r < ROWS && neigh_c >= 0 && neigh_c < COLS) {
-                        if (points[neigh_r][neigh_c].state == 1) {
-                            total_alive_neighbors++;
-                        }
-                    }
-                }
-            }
+    load_pattern(&points, test->pattern, 0, 0);
+    naive_engine.load(&points);
+
+    for (int generation = 0; ; generation++) {
+        reference_digest[generation] = grid_digest(&points);
+        reference_population[generation] = count_population(&points);
+        reference_births[generation] = reference_deaths[generation] = 0;
+
+        // births and deaths cell by cell against the generation before
+        for (int row = 0; generation && row < points.rows; row++) {
+            const uint8_t *now = grid_row(&points, row), *was = grid_row(&previous, row);
+            int born = 0, died = 0;
 
-            // rules
-            if (points[row][col].state == 1) { // if already alive
-                if (total_alive_neighbors  == 2 || total_alive_neighbors == 3)
-                    next_state[row][col] = 1;
-                else
-                    next_state[row][col] = 0;
-            } else {
-                if (total_alive_neighbors == 3)
-                    next_state[row][col] = 1; // rule of birth
-                else
-                    next_state[row][col] = 0; // stays dead
+            for (int col = 0; col < points.cols; col++) {
+                born += now[col] > was[col];
+                died += now[col] < was[col];
             }
-        }
-    }
 
-    // Copy back to original grid
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            points[row][col].state = next_state[row][col];
+            reference_births[generation] += born;
+            reference_deaths[generation] += died;
         }
-    }
-}
 
+        if (!stats_agree(&naive_engine, generation)) {
+            printf("FAIL  naive    %-16s %-8s generation %d: counted other stats than the grid has\n", "reference",
+                   test->pattern, generation);
+            failures++;
+        }
 
-void reset_all_points() {
+        if (!warned && !test->rows && touches_border()) {
+            printf("FAIL  naive    %-16s %-8s reaches the border at generation %d, use a bigger grid\n",
+                   "reference", test->pattern, generation);
+            failures++;
+            warned = 1;
+        }
 
-    for (int row = 0; row < ROWS; row++) {
-        for(int col = 0; col < COLS; col++) {
-            points[row][col].state = 0;
+        if (generation == test->generations) {
+            break;
         }
+
+        SDL_memcpy(previous.cells, points.cells, points.stride * (points.rows + 2));
+        naive_engine.step();
     }
 }
 
-void draw_grid(SDL_Renderer *renderer) {
+// the cycle detector over the reference digests, fed every generation and,
+// the way the callers do, every few generations until it found a multiple
+// of the period
+static const int test_cycle_gaps[] = {1, 5};
 
-    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_GRAY));
+static uint64_t lcm(uint64_t a, uint64_t b) {
 
-    // rows
-    for (int i = 0; i < SCREEN_HEIGHT; i += CELL_SIZE) {
-        SDL_FRect line = {0, i, SCREEN_WIDTH, GRIDLINE_WIDTH};
-        SDL_RenderFillRect(renderer, &line);
-    }
+    uint64_t x = a, y = b;
 
-    // for cols
-    for (int i = 0; i < SCREEN_WIDTH; i += CELL_SIZE) {
-        SDL_FRect line = {i, 0, GRIDLINE_WIDTH, SCREEN_WIDTH};
-        SDL_RenderFillRect(renderer, &line);
+    while (y) {
+        uint64_t t = x % y;
+        x = y;
+        y = t;
     }
 
+    return a / x * b;
 }
 
+// the generations a cycle detector fed every gap generations needs to
+// see the multiple twice and narrow it down to the period
+static int cycle_in_reach(const struct test_case *test, int gap) {
+    return test->period && (uint64_t)test->generations >= reference_start + 2 * lcm(gap, test->period) + gap + test->period;
+}
 
-void toggle_point(SDL_Renderer *renderer, float x, float y, int btnIndex) {
+static void check_cycle(const struct test_case *test) {
 
-   
-    if (x < 0 || x >= SCREEN_WIDTH || y < 0 || y >= SCREEN_HEIGHT) {
-        return;
+    static struct cycle cycle;
+
+    for (int g = 0; g < (int)SDL_arraysize(test_cycle_gaps); g++) {
+        int gap = test_cycle_gaps[g];
+
+        cycle_reset(&cycle);
+
+        for (int generation = 0; generation <= test->generations; generation += cycle.multiple ? 1 : gap) {
+            if (cycle_update(&cycle, generation, reference_digest[generation])) {
+                break;
+            }
+        }
+
+        int start = (int)cycle.start, period = (int)cycle.period;
+        int right;
+
+        if (gap == 1) {
+            // the cycle has to start where the reference first repeats
+            right = period == test->period &&
+                    (!period || (reference_digest[start] == reference_digest[start + period] &&
+                                 (start == 0 || reference_digest[start - 1] != reference_digest[start - 1 + period])));
+            reference_start = cycle.start;
+        } else if (period) {
+            // up to a gap late
+            right = period == test->period && cycle.start >= reference_start && cycle.start < reference_start + gap;
+        } else {
+            right = !cycle_in_reach(test, gap);
+        }
+
+        if (!right) {
+            printf("FAIL  cycle    every %-10d %-8s period %d from generation %d, expected %d\n", gap, test->pattern,
+                   period, start, test->period);
+            failures++;
+            continue;
+        }
+
+        printf("ok    cycle    every %-10d %-8s period %d\n", gap, test->pattern, period);
     }
+}
+
+static void run_engine(const struct engine *engine, const struct test_case *test, const char *variant) {
 
-    int cellRow = y / CELL_SIZE;
-    int cellCol = x / CELL_SIZE;
+    load_pattern(&points, test->pattern, 0, 0);
 
-    if (cellRow < 0 || cellRow >= ROWS || cellCol < 0 || cellCol >= COLS) {
+    if (!engine->load(&points)) {
+        printf("FAIL  %-8s %-16s %-8s couldn't allocate the engine's grid\n", engine->name, variant, test->pattern);
+        failures++;
         return;
     }
 
-    int next_state;
+    // the bounded engines also watch for the reference's cycle like the
+    // callers do, on single steps once they saw a multiple of the period
+    static struct cycle cycle;
+    int watch = engine_bounded(engine);
+    int generation = 0, longest = 1;
 
-    if(1 == btnIndex) {
-        next_state = 1;
-    } else if ((3 == btnIndex) || (4 == btnIndex)) {
-        next_state = 0;
-    }
+    cycle_reset(&cycle);
+    cycle_update(&cycle, 0, reference_digest[0]);
 
-    // draw
-    SDL_FRect point = {(cellCol * CELL_SIZE + GRIDLINE_WIDTH), (cellRow * CELL_SIZE+ 1), CELL_SIZE - GRIDLINE_WIDTH, CELL_SIZE - GRIDLINE_WIDTH};
+    while (generation < test->generations) {
+        int step = (int)engine_step_within(engine, cycle.multiple ? 1 : (uint64_t)(test->generations - generation));
 
-    if (1 == next_state) {
-        SDL_SetRenderDrawColor(renderer, RGBA(COLOR_BLACK));
-    } else {
-        SDL_SetRenderDrawColor(renderer, RGBA(COLOR_WHITE));  
-    }
+        if (!step) {
+            printf("FAIL  %-8s %-16s %-8s generation %d: ran out of memory\n", engine->name, variant, test->pattern,
+                   generation);
+            failures++;
+            return;
+        }
 
-    SDL_RenderFillRect(renderer, &point);
+        generation += step;
+        longest = SDL_max(longest, step);
 
-    points[cellRow][cellCol].state = next_state;
-}
+        if (engine_digest(engine, &points) != reference_digest[generation]) {
+            engine->store(&points);
+            printf("FAIL  %-8s %-16s %-8s generation %d: population %" SDL_PRIu64 ", reference %" SDL_PRIu64 "\n", engine->name, variant,
+                   test->pattern, generation, count_population(&points), reference_population[generation]);
+            failures++;
+            return;
+        }
+
+        if (!stats_agree(engine, generation)) {
+            printf("FAIL  %-8s %-16s %-8s generation %d: population, births or deaths differ from the reference\n",
+                   engine->name, variant, test->pattern, generation);
+            failures++;
+            return;
+        }
+
+        // the digests agree, the reference's will do
+        if (watch) {
+            cycle_update(&cycle, generation, reference_digest[generation]);
+        }
 
+        // at the last generation checked, what the engine stores has to
+        // agree with its own digest
+        if (generation == test->generations) {
+            engine->store(&points);
 
+            if (grid_digest(&points) != reference_digest[generation]) {
+                printf("FAIL  %-8s %-16s %-8s stored grid differs from the digest\n", engine->name, variant,
+                       test->pattern);
+                failures++;
+                return;
+            }
 
-void draw_points(SDL_Renderer *renderer) {
-    
-    SDL_SetRenderDrawColor(renderer, RGBA(COLOR_BLACK));
+            // and so does what it packs for the frames, the grid cleared
+            // first so a pack() that stored would show
+            int words = (points.cols + 63) / 64;
+            uint64_t *bits = SDL_malloc((size_t)points.rows * words * sizeof(uint64_t));
 
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col <COLS; col++){
-            if(1 == points[row][col].state) {
-                SDL_FRect point = {(col * CELL_SIZE + GRIDLINE_WIDTH), (row * CELL_SIZE+ 1), CELL_SIZE - GRIDLINE_WIDTH, CELL_SIZE - GRIDLINE_WIDTH};
+            reset_all_points(&points);
 
-                SDL_RenderFillRect(renderer, &point);
+            if (bits) {
+                engine_pack(engine, &points, bits, words);
+            }
 
+            if (!bits || digest_rows(bits, words, points.rows, points.cols) != reference_digest[generation]) {
+                printf("FAIL  %-8s %-16s %-8s packed grid differs from the digest\n", engine->name, variant,
+                       test->pattern);
+                SDL_free(bits);
+                failures++;
+                return;
             }
+
+            SDL_free(bits);
         }
     }
 
+    if (watch && (cycle.period ? (int)cycle.period != test->period : cycle_in_reach(test, longest))) {
+        printf("FAIL  %-8s %-16s %-8s period %d, expected %d\n", engine->name, variant, test->pattern,
+               (int)cycle.period, test->period);
+        failures++;
+        return;
+    }
+
+    char rule_text[32];
+    format_rule(&rule, rule_text, sizeof(rule_text));
+
+    printf("ok    %-8s %-16s %-8s %d generations, %s, %s\n", engine->name, variant, test->pattern, test->generations,
+           boundary_names[boundary], rule_text);
 }
 
-void handleMouseClick(SDL_Renderer *renderer, SDL_MouseButtonEvent *button) {
+int main(void) {
 
-    int btnIndex = button->button;
-    float mouseX = button->x;
-    float mouseY = button->y;
+    int max_generations = 0;
 
-    if(btnIndex) {
-        toggle_point(renderer, mouseX, mouseY, btnIndex);
+    for (int t = 0; t < (int)SDL_arraysize(test_cases); t++) {
+        max_generations = SDL_max(max_generations, test_cases[t].generations);
     }
 
-}
+    reference_digest = SDL_malloc((max_generations + 1) * sizeof(*reference_digest));
+    reference_population = SDL_malloc((max_generations + 1) * sizeof(*reference_population));
+    reference_births = SDL_malloc((max_generations + 1) * sizeof(*reference_births));
+    reference_deaths = SDL_malloc((max_generations + 1) * sizeof(*reference_deaths));
 
-
-int main() {
-    // initializing SDL
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        printf("SDL couldn't be initialized! SDL_Errow: %s\n", SDL_GetError());
+    if (!reference_digest || !reference_population || !reference_births || !reference_deaths) {
+        printf("Couldn't allocate the reference!\n");
         return 1;
     }
 
-    // printing controls
-    printf("\n          Controls\n");
-    printf("\n    Right Click : Populate Cell\n");
-    printf("    Left Click  : Depopulate Cell\n");
-    printf("    Space       : Reset\n");
-    printf("    Enter       : Start Game\n");
-    printf("    ESC         : Pause Game\n");
-    printf("    E           : End Game\n");
+    enum simd_level best = detect_simd();
 
-    SDL_Window *window = SDL_CreateWindow("Conway's Game of Life", SCREEN_WIDTH, SCREEN_HEIGHT, 0);
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, NULL);
+    for (int t = 0; t < (int)SDL_arraysize(test_cases); t++) {
+        const struct test_case *test = &test_cases[t];
 
-    SDL_FRect white_screen = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+        boundary = test->boundary;
 
-    init_points();
+        if (!parse_rule(test->rule ? test->rule : "B3/S23", &rule)) {
+            printf("FAIL  %-8s %-16s %-8s can't parse rule %s\n", "rule", "", test->pattern, test->rule);
+            failures++;
+            continue;
+        }
 
-    int running = 1;
+        int rows = test->rows ? test->rows : TEST_ROWS, cols = test->cols ? test->cols : TEST_COLS;
 
-    int gameStarted = 0;
-    int gamePaused = 0;
+        if (!init_points(&points, rows, cols) || !init_points(&previous, rows, cols)) {
+            printf("Couldn't allocate the grid!\n");
+            return 1;
+        }
 
-    int isMouseDown;
+        run_reference(test);
 
-    int generation_counter = 0;
+        // the reference itself against the known population
+        if (reference_population[test->generations] != (uint64_t)test->population) {
+            printf("FAIL  naive    %-16s %-8s population %" SDL_PRIu64 " after %d generations, expected %d\n", "reference",
+                   test->pattern, reference_population[test->generations], test->generations, test->population);
+            failures++;
+        }
 
-    while(running) {
+        check_cycle(test);
 
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        for (int e = 0; engines[e]; e++) {
+            const struct engine *engine = engines[e];
+            char variant[32];
 
-            switch(event.type) {
-                case SDL_EVENT_QUIT:
-                    running = 0; break;
+            if (engine == &naive_engine || (test->rows && !engine_bounded(engine))) {
+                continue;
+            }
 
-                case SDL_EVENT_MOUSE_BUTTON_DOWN:
-                    isMouseDown = 1; break;
+            if (engine == &hashlife_engine) {
+                for (int s = 0; s < (int)SDL_arraysize(test_hashlife_steps); s++) {
+                    hashlife_step_log2 = test_hashlife_steps[s];
+                    SDL_snprintf(variant, sizeof(variant), "step 2^%d", hashlife_step_log2);
+                    run_engine(engine, test, variant);
+                }
 
-                case SDL_EVENT_MOUSE_BUTTON_UP:
-                    isMouseDown = 0; break;
+                hashlife_step_log2 = 0;
+                continue;
+            }
 
-                case SDL_EVENT_KEY_DOWN:
-                    if(event.key.key == SDLK_SPACE && !gameStarted) {
-                        reset_all_points();
-                    }
+            // only these run on the worker pool
+            if (engine != &bytes_engine && engine != &bits_engine && engine != &lut_engine) {
+                run_engine(engine, test, "");
+                continue;
+            }
 
-                    if(event.key.key == SDLK_RETURN) {
-                        gameStarted = 1;
-                    }
+            // every kernel level the cpu has for the ones with vector
+            // kernels, on one and several threads. lut has none
+            int vector = engine != &lut_engine;
 
-                    if (event.key.key == SDLK_E) {
-                        gameStarted = 0;
-                    }
+            for (int level = SIMD_SCALAR; level <= (vector ? (int)best : SIMD_SCALAR); level++) {
+                for (int n = 0; n < (int)SDL_arraysize(test_threads); n++) {
+                    simd_level = level;
 
-                    if (event.key.key == SDLK_ESCAPE) {
-                        gamePaused = (gamePaused == 0)? 1 : 0; 
+                    if (!workers_start(test_threads[n])) {
+                        printf("Couldn't start worker threads!\n");
+                        return 1;
                     }
 
-                default:
-                    break;
-            }
-
-            if(isMouseDown && !gameStarted) {
-                handleMouseClick(renderer, &event.button);
-            }
-
-        }
+                    if (vector) {
+                        SDL_snprintf(variant, sizeof(variant), "%s/%d threads", simd_names[level], worker_count());
+                    } else {
+                        SDL_snprintf(variant, sizeof(variant), "%d threads", worker_count());
+                    }
 
-        if (!gamePaused) {
+                    if (engine != &bits_engine) {
+                        run_engine(engine, test, variant);
+                        continue;
+                    }
 
-            
-            // re-draw white bg on each update
-            SDL_SetRenderDrawColor(renderer, RGBA(COLOR_WHITE));
-            SDL_RenderFillRect(renderer, &white_screen);
+                    for (int b = 0; b < (int)SDL_arraysize(test_bits_blocks); b++) {
+                        bits_block_generations = test_bits_blocks[b];
 
+                        if (bits_block_generations > 1) {
+                            SDL_snprintf(variant, sizeof(variant), "%s/%d threads/%d", simd_names[level], worker_count(),
+                                         bits_block_generations);
+                        }
 
-            // draw grid
-            draw_grid(renderer);
+                        run_engine(engine, test, variant);
+                    }
 
-            if (gameStarted) {
-                if (generation_counter > GENERATION_SPEED){
-                    update_points();
-                    generation_counter = 0;
-                } else {
-                    generation_counter++;
+                    bits_block_generations = 1;
                 }
             }
-
-            draw_points(renderer);
-            SDL_RenderPresent(renderer);
         }
-
-
-        SDL_Delay(20);
     }
 
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    workers_stop();
+    free_points(&points);
+    free_points(&previous);
+    SDL_free(reference_digest);
+    SDL_free(reference_population);
+    SDL_free(reference_births);
+    SDL_free(reference_deaths);
 
+    if (failures) {
+        printf("\n%d failed\n", failures);
+        return 1;
+    }
 
+    printf("\nall passed\n");
     return 0;
 }
-
@@ -0,0 +1,156 @@
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_cpuinfo.h>
+#include "life.h"
+
+// persistent worker pool: the grid is cut into one horizontal band per
+// thread, the calling thread computes the first band itself and then waits
+// on a barrier until every worker has finished its band.
+
+#define MAX_WORKERS 64
+
+static SDL_Thread *worker_threads[MAX_WORKERS];
+static int worker_total = 1; // threads including the caller
+
+static SDL_Mutex *job_lock;
+static SDL_Condition *job_ready;
+static SDL_Semaphore *job_done;
+static int job_id;     // bumped for every job, workers wait for it to change
+static int job_quit;
+
+static band_fn job_band;
+static void *job_data;
+static int job_rows;
+
+static SDL_AtomicInt bands_left; // the last worker to finish signals job_done
+
+
+static void run_band(int index) {
+
+    int begin = (int)((long long)job_rows * index / worker_total);
+    int end = (int)((long long)job_rows * (index + 1) / worker_total);
+
+    if (begin < end) {
+        job_band(begin, end, job_data);
+    }
+}
+
+static int worker_main(void *arg) {
+
+    int index = (int)(intptr_t)arg;
+    int seen = 0;
+
+    for (;;) {
+        SDL_LockMutex(job_lock);
+
+        while (job_id == seen && !job_quit) {
+            SDL_WaitCondition(job_ready, job_lock);
+        }
+
+        seen = job_id;
+        int quit = job_quit;
+        SDL_UnlockMutex(job_lock);
+
+        if (quit) {
+            return 0;
+        }
+
+        run_band(index);
+
+        if (SDL_AddAtomicInt(&bands_left, -1) == 1) {
+            SDL_SignalSemaphore(job_done);
+        }
+    }
+}
+
+int workers_start(int threads) {
+
+    workers_stop();
+
+    if (threads <= 0) {
+        threads = SDL_GetNumLogicalCPUCores();
+    }
+
+    threads = SDL_clamp(threads, 1, MAX_WORKERS);
+
+    if (threads == 1) {
+        return 1;
+    }
+
+    job_lock = SDL_CreateMutex();
+    job_ready = SDL_CreateCondition();
+    job_done = SDL_CreateSemaphore(0);
+
+    if (!job_lock || !job_ready || !job_done) {
+        workers_stop();
+        return 0;
+    }
+
+    // new workers start from job 0, so must the counter after a restart
+    job_quit = 0;
+    job_id = 0;
+
+    for (int i = 1; i < threads; i++) {
+        worker_threads[i] = SDL_CreateThread(worker_main, "life worker", (void *)(intptr_t)i);
+
+        if (!worker_threads[i]) {
+            workers_stop();
+            return 0;
+        }
+
+        worker_total = i + 1;
+    }
+
+    return 1;
+}
+
+void workers_stop(void) {
+
+    if (job_lock) {
+        SDL_LockMutex(job_lock);
+        job_quit = 1;
+        SDL_BroadcastCondition(job_ready);
+        SDL_UnlockMutex(job_lock);
+    }
+
+    for (int i = 1; i < worker_total; i++) {
+        SDL_WaitThread(worker_threads[i], NULL);
+        worker_threads[i] = NULL;
+    }
+
+    worker_total = 1;
+
+    SDL_DestroySemaphore(job_done);
+    SDL_DestroyCondition(job_ready);
+    SDL_DestroyMutex(job_lock);
+    job_done = NULL;
+    job_ready = NULL;
+    job_lock = NULL;
+}
+
+int worker_count(void) {
+    return worker_total;
+}
+
+void workers_run(band_fn band, void *data, int rows) {
+
+    if (worker_total == 1) {
+        band(0, rows, data);
+        return;
+    }
+
+    SDL_LockMutex(job_lock);
+    job_band = band;
+    job_data = data;
+    job_rows = rows;
+    SDL_SetAtomicInt(&bands_left, worker_total - 1);
+    job_id++;
+    SDL_BroadcastCondition(job_ready);
+    SDL_UnlockMutex(job_lock);
+
+    run_band(0);
+
+    // barrier until the last band is done
+    SDL_WaitSemaphore(job_done);
+}